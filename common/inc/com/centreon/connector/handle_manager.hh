@@ -0,0 +1,86 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCC_HANDLE_MANAGER_HH
+#  define CCC_HANDLE_MANAGER_HH
+
+#  include <map>
+#  include <set>
+#  include "com/centreon/connector/namespace.hh"
+#  include "com/centreon/handle.hh"
+#  include "com/centreon/handle_listener.hh"
+#  include "com/centreon/task_manager.hh"
+
+CCC_BEGIN()
+
+/**
+ *  @class handle_manager handle_manager.hh "com/centreon/connector/handle_manager.hh"
+ *  @brief epoll-based handle multiplexing.
+ *
+ *  Replacement of com::centreon::handle_manager built on epoll, shared
+ *  by all connectors. The interest of a handle (want_read() /
+ *  want_write()) is only evaluated when it is registered, after one of
+ *  its events was dispatched or when update() is called, so an
+ *  iteration costs O(ready handles) instead of O(registered handles).
+ *
+ *  Code that changes the interest of a handle outside of its own
+ *  callbacks (for example when data is queued for writing) must call
+ *  update(), otherwise the handle is not polled for the new events.
+ *  Listeners are always called from the multiplexing thread.
+ */
+class              handle_manager {
+public:
+                   handle_manager(com::centreon::task_manager* tm = NULL);
+  virtual          ~handle_manager() throw ();
+  void             add(
+                     handle* h,
+                     handle_listener* hl,
+                     bool is_threadable = false);
+  void             multiplex();
+  bool             remove(handle* h);
+  unsigned int     remove(handle_listener* hl);
+  void             update(handle* h);
+
+private:
+  struct           registration {
+    unsigned int     events;
+    native_handle    fd;
+    handle_listener* listener;
+  };
+
+                   handle_manager(handle_manager const& hm);
+  handle_manager&  operator=(handle_manager const& hm);
+  void             _dispatch(handle* h, unsigned int events);
+  void             _remove(
+                     std::map<handle*, registration>::iterator it);
+  void             _setup();
+
+  std::set<handle*>
+                   _dirty;
+  native_handle    _epoll_fd;
+  std::map<native_handle, handle*>
+                   _fds;
+  std::map<handle*, registration>
+                   _handles;
+  com::centreon::task_manager*
+                   _task_manager;
+};
+
+CCC_END()
+
+#endif // !CCC_HANDLE_MANAGER_HH
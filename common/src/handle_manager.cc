@@ -0,0 +1,295 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "com/centreon/connector/handle_manager.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+#include "com/centreon/timestamp.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector;
+
+// Maximum number of events fetched by one epoll_wait() call.
+#define MAX_EVENTS 256
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] tm Task manager whose tasks are executed while
+ *                multiplexing.
+ */
+handle_manager::handle_manager(task_manager* tm)
+  : _epoll_fd(native_handle_null), _task_manager(tm) {
+  _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (_epoll_fd < 0) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not create epoll instance: " << msg);
+  }
+}
+
+/**
+ *  Destructor.
+ */
+handle_manager::~handle_manager() throw () {
+  ::close(_epoll_fd);
+}
+
+/**
+ *  Register a handle.
+ *
+ *  @param[in] h             Handle.
+ *  @param[in] hl            Listener that will receive handle events.
+ *  @param[in] is_threadable Unused, kept for compatibility with
+ *                           com::centreon::handle_manager.
+ */
+void handle_manager::add(
+                       handle* h,
+                       handle_listener* hl,
+                       bool is_threadable) {
+  (void)is_threadable;
+  if (!h)
+    throw (basic_error() << "attempt to add null handle in handle manager");
+  if (!hl)
+    throw (basic_error()
+           << "attempt to add null listener in handle manager");
+  if (_handles.find(h) != _handles.end())
+    throw (basic_error() << "handle is already registered");
+  native_handle fd(h->get_native_handle());
+  if (fd == native_handle_null)
+    throw (basic_error() << "attempt to add invalid handle in handle manager");
+
+  // A handle still registered with this descriptor was closed without
+  // being removed. The kernel already dropped its registration.
+  std::map<native_handle, handle*>::iterator stale(_fds.find(fd));
+  if (stale != _fds.end()) {
+    log_debug(logging::low) << "handle " << stale->second
+      << " was closed without being removed from handle manager";
+    _dirty.erase(stale->second);
+    _handles.erase(stale->second);
+    _fds.erase(stale);
+  }
+
+  // Register with epoll. Interest is computed before next wait.
+  epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.data.ptr = h;
+  if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev)) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not add handle to epoll: " << msg);
+  }
+  registration& r(_handles[h]);
+  r.events = 0;
+  r.fd = fd;
+  r.listener = hl;
+  _fds[fd] = h;
+  _dirty.insert(h);
+  return ;
+}
+
+/**
+ *  Wait for events on handles and dispatch them. Tasks are executed
+ *  when their time has come.
+ */
+void handle_manager::multiplex() {
+  if (!_task_manager)
+    throw (basic_error()
+           << "cannot multiplex handles with no task manager");
+
+  // Update interests.
+  _setup();
+
+  // Determine timeout.
+  int timeout;
+  timestamp next(_task_manager->next_execution_time());
+  if (next == timestamp::max_time())
+    timeout = -1;
+  else {
+    timestamp now(timestamp::now());
+    timeout = ((next <= now)
+               ? 0
+               : static_cast<int>(next.to_mseconds()
+                                  - now.to_mseconds() + 1));
+  }
+
+  // Wait for events.
+  epoll_event events[MAX_EVENTS];
+  int ret(epoll_wait(_epoll_fd, events, MAX_EVENTS, timeout));
+  if (ret < 0) {
+    if (errno != EINTR) {
+      char const* msg(strerror(errno));
+      throw (basic_error() << "epoll_wait failed: " << msg);
+    }
+    ret = 0;
+  }
+
+  // Execute tasks.
+  _task_manager->execute(timestamp::now());
+
+  // Dispatch events.
+  for (int i(0); i < ret; ++i)
+    _dispatch(
+      static_cast<handle*>(events[i].data.ptr),
+      events[i].events);
+  return ;
+}
+
+/**
+ *  Remove a handle.
+ *
+ *  @param[in] h Handle to remove.
+ *
+ *  @return true if handle was registered.
+ */
+bool handle_manager::remove(handle* h) {
+  std::map<handle*, registration>::iterator it(_handles.find(h));
+  if (it == _handles.end())
+    return (false);
+  _remove(it);
+  return (true);
+}
+
+/**
+ *  Remove all handles associated with a listener.
+ *
+ *  @param[in] hl Listener.
+ *
+ *  @return Number of handles removed.
+ */
+unsigned int handle_manager::remove(handle_listener* hl) {
+  unsigned int count(0);
+  std::map<handle*, registration>::iterator it(_handles.begin());
+  while (it != _handles.end()) {
+    if (it->second.listener == hl) {
+      _remove(it++);
+      ++count;
+    }
+    else
+      ++it;
+  }
+  return (count);
+}
+
+/**
+ *  @brief Notify the handle manager that a handle interest might have
+ *  changed.
+ *
+ *  Its listener's want_read() and want_write() will be called before
+ *  next wait.
+ *
+ *  @param[in] h Handle.
+ */
+void handle_manager::update(handle* h) {
+  if (_handles.find(h) != _handles.end())
+    _dirty.insert(h);
+  return ;
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Dispatch events of a handle.
+ *
+ *  @param[in] h      Handle.
+ *  @param[in] events epoll events.
+ */
+void handle_manager::_dispatch(handle* h, unsigned int events) {
+  // Handle might have been removed by a previous callback.
+  std::map<handle*, registration>::iterator it(_handles.find(h));
+  if (it == _handles.end())
+    return ;
+  handle_listener* hl(it->second.listener);
+  _dirty.insert(h);
+
+  if ((events & EPOLLERR)
+      || ((events & EPOLLHUP) && !(it->second.events & EPOLLIN)))
+    hl->error(*h);
+  else {
+    if (events & EPOLLOUT)
+      hl->write(*h);
+    if ((events & (EPOLLIN | EPOLLHUP))
+        && (_handles.find(h) != _handles.end()))
+      hl->read(*h);
+  }
+  return ;
+}
+
+/**
+ *  Unregister a handle.
+ *
+ *  @param[in] it Handle iterator.
+ */
+void handle_manager::_remove(
+                       std::map<handle*, registration>::iterator it) {
+  // Do not unregister another handle that reused the descriptor.
+  std::map<native_handle, handle*>::iterator fd(_fds.find(it->second.fd));
+  if ((fd != _fds.end()) && (fd->second == it->first)) {
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, it->second.fd, &ev);
+    _fds.erase(fd);
+  }
+  _dirty.erase(it->first);
+  _handles.erase(it);
+  return ;
+}
+
+/**
+ *  Update epoll interest of handles that might have changed.
+ */
+void handle_manager::_setup() {
+  while (!_dirty.empty()) {
+    handle* h(*_dirty.begin());
+    _dirty.erase(_dirty.begin());
+    std::map<handle*, registration>::iterator it(_handles.find(h));
+    if (it == _handles.end())
+      continue ;
+    handle_listener* hl(it->second.listener);
+    unsigned int events((hl->want_read(*h) ? static_cast<unsigned int>(EPOLLIN) : 0u)
+                        | (hl->want_write(*h) ? static_cast<unsigned int>(EPOLLOUT) : 0u));
+
+    // want_*() might have removed the handle.
+    it = _handles.find(h);
+    if ((it == _handles.end()) || (events == it->second.events))
+      continue ;
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = h;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, it->second.fd, &ev)) {
+      char const* msg(strerror(errno));
+      throw (basic_error()
+             << "could not update handle in epoll: " << msg);
+    }
+    it->second.events = events;
+  }
+  return ;
+}
@@ -0,0 +1,94 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include "com/centreon/clib.hh"
+#include "com/centreon/connector/handle_manager.hh"
+#include "com/centreon/task_manager.hh"
+#include "test/handle_manager/pipe_end.hh"
+#include "test/handle_manager/recorder.hh"
+
+using namespace com::centreon;
+
+/**
+ *  Check that handles are registered and that their events are
+ *  dispatched.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  clib::load();
+  int retval(EXIT_SUCCESS);
+  try {
+    task_manager tm;
+    connector::handle_manager hm(&tm);
+    pipe_end reader;
+    pipe_end writer;
+    pipe_end::open(reader, writer);
+    recorder rec;
+
+    // Invalid registrations.
+    try {
+      hm.add(NULL, &rec);
+      std::cerr << "null handle was registered" << std::endl;
+      retval = EXIT_FAILURE;
+    }
+    catch (std::exception const& e) {
+      (void)e;
+    }
+    try {
+      hm.add(&reader, NULL);
+      std::cerr << "null listener was registered" << std::endl;
+      retval = EXIT_FAILURE;
+    }
+    catch (std::exception const& e) {
+      (void)e;
+    }
+
+    // Registered handle is dispatched when it is readable.
+    hm.add(&reader, &rec);
+    try {
+      hm.add(&reader, &rec);
+      std::cerr << "handle was registered twice" << std::endl;
+      retval = EXIT_FAILURE;
+    }
+    catch (std::exception const& e) {
+      (void)e;
+    }
+    multiplex_once(hm, tm);
+    if (rec.reads) {
+      std::cerr << "empty pipe was read" << std::endl;
+      retval = EXIT_FAILURE;
+    }
+    writer.write("x", 1);
+    multiplex_once(hm, tm);
+    if (rec.reads != 1) {
+      std::cerr << "readable pipe was read " << rec.reads
+                << " times instead of 1" << std::endl;
+      retval = EXIT_FAILURE;
+    }
+    hm.remove(&reader);
+  }
+  catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    retval = EXIT_FAILURE;
+  }
+  clib::unload();
+  return (retval);
+}
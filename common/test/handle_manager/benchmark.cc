@@ -0,0 +1,179 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <vector>
+#include "com/centreon/clib.hh"
+#include "com/centreon/connector/handle_manager.hh"
+#include "com/centreon/handle.hh"
+#include "com/centreon/handle_listener.hh"
+#include "com/centreon/handle_manager.hh"
+#include "com/centreon/task_manager.hh"
+#include "com/centreon/timestamp.hh"
+
+using namespace com::centreon;
+
+/**
+ *  Read end of a pipe.
+ */
+class          pipe_end : public handle {
+public:
+               pipe_end(native_handle fd) : _fd(fd) {}
+               ~pipe_end() throw () { close(); }
+  void         close() {
+    if (_fd != native_handle_null) {
+      ::close(_fd);
+      _fd = native_handle_null;
+    }
+    return ;
+  }
+  native_handle
+               get_native_handle() { return (_fd); }
+  unsigned long
+               read(void* data, unsigned long size) {
+    return (::read(_fd, data, size));
+  }
+  unsigned long
+               write(void const* data, unsigned long size) {
+    return (::write(_fd, data, size));
+  }
+
+private:
+  native_handle
+               _fd;
+};
+
+/**
+ *  Drain pipes when they are readable.
+ */
+class          drainer : public handle_listener {
+public:
+               drainer() : reads(0) {}
+  void         error(handle& h) { (void)h; return ; }
+  void         read(handle& h) {
+    char buffer[16];
+    h.read(buffer, sizeof(buffer));
+    ++reads;
+    return ;
+  }
+  bool         want_read(handle& h) { (void)h; return (true); }
+  bool         want_write(handle& h) { (void)h; return (false); }
+  void         write(handle& h) { (void)h; return ; }
+
+  unsigned int reads;
+};
+
+/**
+ *  Measure the mean duration of one multiplexing iteration when only
+ *  one handle out of many is ready.
+ *
+ *  @param[in] hm          Handle manager.
+ *  @param[in] ends        Read ends of pipes.
+ *  @param[in] writers     Write ends of pipes.
+ *  @param[in] iterations  Number of iterations.
+ *
+ *  @return Mean iteration duration in microseconds.
+ */
+template        <typename T>
+static double   bench(
+                  T& hm,
+                  std::vector<pipe_end*>& ends,
+                  std::vector<int>& writers,
+                  unsigned int iterations) {
+  drainer d;
+  for (unsigned int i(0); i < ends.size(); ++i)
+    hm.add(ends[i], &d);
+
+  timestamp start(timestamp::now());
+  for (unsigned int i(0); i < iterations; ++i) {
+    if (::write(writers[rand() % writers.size()], "x", 1) != 1)
+      break ;
+    hm.multiplex();
+  }
+  timestamp end(timestamp::now());
+
+  for (unsigned int i(0); i < ends.size(); ++i)
+    hm.remove(ends[i]);
+  return (static_cast<double>(end.to_useconds() - start.to_useconds())
+          / (d.reads ? d.reads : 1));
+}
+
+/**
+ *  Compare epoll-based multiplexing with clib's handle manager.
+ *
+ *  Usage: multiplexer_benchmark [handles] [iterations]
+ *
+ *  @return 0 on success.
+ */
+int main(int argc, char* argv[]) {
+  unsigned int handles((argc > 1) ? strtoul(argv[1], NULL, 10) : 1000);
+  unsigned int iterations((argc > 2) ? strtoul(argv[2], NULL, 10) : 1000);
+
+  // Raise descriptor limit.
+  rlimit lim;
+  if (!getrlimit(RLIMIT_NOFILE, &lim)
+      && (lim.rlim_cur < 2 * handles + 64)) {
+    lim.rlim_cur = 2 * handles + 64;
+    if (lim.rlim_max < lim.rlim_cur)
+      lim.rlim_cur = lim.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &lim);
+  }
+
+  clib::load();
+  int retval(0);
+  std::vector<pipe_end*> ends;
+  std::vector<int> writers;
+  for (unsigned int i(0); i < handles; ++i) {
+    int fds[2];
+    if (pipe(fds)) {
+      std::cerr << "could only create " << i << " pipes" << std::endl;
+      retval = 1;
+      break ;
+    }
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    ends.push_back(new pipe_end(fds[0]));
+    writers.push_back(fds[1]);
+  }
+
+  if (!retval) {
+    task_manager tm;
+    {
+      connector::handle_manager hm(&tm);
+      std::cout << "epoll:  " << bench(hm, ends, writers, iterations)
+                << " us/iteration with " << handles << " handles"
+                << std::endl;
+    }
+    {
+      handle_manager hm(&tm);
+      std::cout << "legacy: " << bench(hm, ends, writers, iterations)
+                << " us/iteration with " << handles << " handles"
+                << std::endl;
+    }
+  }
+
+  for (unsigned int i(0); i < ends.size(); ++i) {
+    delete ends[i];
+    ::close(writers[i]);
+  }
+  clib::unload();
+  return (retval);
+}
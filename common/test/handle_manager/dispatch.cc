@@ -0,0 +1,120 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include "com/centreon/clib.hh"
+#include "com/centreon/connector/handle_manager.hh"
+#include "com/centreon/task_manager.hh"
+#include "test/handle_manager/pipe_end.hh"
+#include "test/handle_manager/recorder.hh"
+
+using namespace com::centreon;
+
+namespace {
+  /**
+   *  Listener that removes all its handles on first read.
+   */
+  class      remover : public recorder {
+  public:
+             remover(connector::handle_manager& hm) : _hm(hm) {}
+    void     read(handle& h) {
+      recorder::read(h);
+      _hm.remove(this);
+      return ;
+    }
+
+  private:
+    connector::handle_manager&
+             _hm;
+  };
+}
+
+/**
+ *  Check how events are dispatched to listeners.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  clib::load();
+  int retval(EXIT_SUCCESS);
+  try {
+    task_manager tm;
+    connector::handle_manager hm(&tm);
+
+    // Hang up is a read (EOF) when the handle wants to read.
+    {
+      pipe_end reader;
+      pipe_end writer;
+      pipe_end::open(reader, writer);
+      recorder rec;
+      hm.add(&reader, &rec);
+      writer.close();
+      multiplex_once(hm, tm);
+      if ((rec.reads != 1) || rec.errors) {
+        std::cerr << "hang up was not dispatched as a read" << std::endl;
+        retval = EXIT_FAILURE;
+      }
+      hm.remove(&reader);
+    }
+
+    // Hang up is an error otherwise.
+    {
+      pipe_end reader;
+      pipe_end writer;
+      pipe_end::open(reader, writer);
+      recorder rec(false, false);
+      hm.add(&reader, &rec);
+      writer.close();
+      multiplex_once(hm, tm);
+      if (rec.reads || (rec.errors != 1)) {
+        std::cerr << "hang up was not dispatched as an error"
+                  << std::endl;
+        retval = EXIT_FAILURE;
+      }
+      hm.remove(&reader);
+    }
+
+    // Handles removed by a previous callback of the same iteration
+    // are not dispatched.
+    {
+      pipe_end reader1;
+      pipe_end writer1;
+      pipe_end::open(reader1, writer1);
+      pipe_end reader2;
+      pipe_end writer2;
+      pipe_end::open(reader2, writer2);
+      remover rem(hm);
+      hm.add(&reader1, &rem);
+      hm.add(&reader2, &rem);
+      writer1.write("x", 1);
+      writer2.write("x", 1);
+      multiplex_once(hm, tm);
+      if (rem.reads != 1) {
+        std::cerr << "removed handle was dispatched" << std::endl;
+        retval = EXIT_FAILURE;
+      }
+    }
+  }
+  catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    retval = EXIT_FAILURE;
+  }
+  clib::unload();
+  return (retval);
+}
@@ -0,0 +1,105 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "com/centreon/exceptions/basic.hh"
+#include "test/handle_manager/pipe_end.hh"
+
+using namespace com::centreon;
+
+/**
+ *  Default constructor.
+ */
+pipe_end::pipe_end() : _fd(native_handle_null) {}
+
+/**
+ *  Destructor.
+ */
+pipe_end::~pipe_end() throw () {
+  close();
+}
+
+/**
+ *  Close the pipe end.
+ */
+void pipe_end::close() {
+  if (_fd != native_handle_null) {
+    ::close(_fd);
+    _fd = native_handle_null;
+  }
+  return ;
+}
+
+/**
+ *  Get the pipe descriptor.
+ *
+ *  @return Native handle.
+ */
+native_handle pipe_end::get_native_handle() {
+  return (_fd);
+}
+
+/**
+ *  Open a pipe.
+ *
+ *  @param[out] reader Read end.
+ *  @param[out] writer Write end.
+ */
+void pipe_end::open(pipe_end& reader, pipe_end& writer) {
+  int fds[2];
+  if (pipe(fds)) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not create pipe: " << msg);
+  }
+  fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+  fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+  reader.close();
+  reader._fd = fds[0];
+  writer.close();
+  writer._fd = fds[1];
+  return ;
+}
+
+/**
+ *  Read data.
+ *
+ *  @param[out] data Buffer.
+ *  @param[in]  size Buffer size.
+ *
+ *  @return Number of bytes read.
+ */
+unsigned long pipe_end::read(void* data, unsigned long size) {
+  ssize_t rb(::read(_fd, data, size));
+  return ((rb < 0) ? 0 : rb);
+}
+
+/**
+ *  Write data.
+ *
+ *  @param[in] data Data.
+ *  @param[in] size Data size.
+ *
+ *  @return Number of bytes written.
+ */
+unsigned long pipe_end::write(void const* data, unsigned long size) {
+  ssize_t wb(::write(_fd, data, size));
+  return ((wb < 0) ? 0 : wb);
+}
@@ -0,0 +1,47 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef TEST_HANDLE_MANAGER_PIPE_END_HH
+#  define TEST_HANDLE_MANAGER_PIPE_END_HH
+
+#  include "com/centreon/handle.hh"
+
+/**
+ *  @class pipe_end pipe_end.hh "test/handle_manager/pipe_end.hh"
+ *  @brief One end of a non-blocking pipe.
+ */
+class            pipe_end : public com::centreon::handle {
+public:
+                 pipe_end();
+                 ~pipe_end() throw ();
+  void           close();
+  com::centreon::native_handle
+                 get_native_handle();
+  static void    open(pipe_end& reader, pipe_end& writer);
+  unsigned long  read(void* data, unsigned long size);
+  unsigned long  write(void const* data, unsigned long size);
+
+private:
+                 pipe_end(pipe_end const& pe);
+  pipe_end&      operator=(pipe_end const& pe);
+
+  com::centreon::native_handle
+                 _fd;
+};
+
+#endif // !TEST_HANDLE_MANAGER_PIPE_END_HH
@@ -0,0 +1,128 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include "com/centreon/task.hh"
+#include "com/centreon/timestamp.hh"
+#include "test/handle_manager/recorder.hh"
+
+using namespace com::centreon;
+
+namespace {
+  /**
+   *  Task that does nothing but bounds a multiplexing iteration.
+   */
+  class  noop : public task {
+  public:
+    void run() {}
+  };
+}
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] want_read  Initial read interest.
+ *  @param[in] want_write Initial write interest.
+ */
+recorder::recorder(bool want_read, bool want_write)
+  : errors(0),
+    read_interest(want_read),
+    reads(0),
+    write_interest(want_write),
+    write_once(false),
+    writes(0) {}
+
+/**
+ *  Destructor.
+ */
+recorder::~recorder() throw () {}
+
+/**
+ *  Error on handle.
+ *
+ *  @param[in] h Handle.
+ */
+void recorder::error(handle& h) {
+  (void)h;
+  ++errors;
+  return ;
+}
+
+/**
+ *  Drain readable handle.
+ *
+ *  @param[in] h Handle.
+ */
+void recorder::read(handle& h) {
+  char buffer[4096];
+  h.read(buffer, sizeof(buffer));
+  ++reads;
+  return ;
+}
+
+/**
+ *  Read interest.
+ *
+ *  @param[in] h Handle.
+ *
+ *  @return read_interest.
+ */
+bool recorder::want_read(handle& h) {
+  (void)h;
+  return (read_interest);
+}
+
+/**
+ *  Write interest.
+ *
+ *  @param[in] h Handle.
+ *
+ *  @return write_interest.
+ */
+bool recorder::want_write(handle& h) {
+  (void)h;
+  return (write_interest);
+}
+
+/**
+ *  Write one byte on writable handle.
+ *
+ *  @param[in] h Handle.
+ */
+void recorder::write(handle& h) {
+  h.write("x", 1);
+  ++writes;
+  if (write_once)
+    write_interest = false;
+  return ;
+}
+
+/**
+ *  Run one multiplexing iteration that waits at most 100ms.
+ *
+ *  @param[in] hm Handle manager.
+ *  @param[in] tm Task manager of the handle manager.
+ */
+void multiplex_once(
+       connector::handle_manager& hm,
+       task_manager& tm) {
+  timestamp when(timestamp::now());
+  when.add_mseconds(100);
+  tm.add(new noop, when, false, true);
+  hm.multiplex();
+  return ;
+}
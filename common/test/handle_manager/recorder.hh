@@ -0,0 +1,55 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef TEST_HANDLE_MANAGER_RECORDER_HH
+#  define TEST_HANDLE_MANAGER_RECORDER_HH
+
+#  include "com/centreon/connector/handle_manager.hh"
+#  include "com/centreon/handle_listener.hh"
+#  include "com/centreon/task_manager.hh"
+
+/**
+ *  @class recorder recorder.hh "test/handle_manager/recorder.hh"
+ *  @brief Handle listener that counts the events it receives.
+ *
+ *  Interest is given by public members so that tests can change it
+ *  outside of a dispatch.
+ */
+class            recorder : public com::centreon::handle_listener {
+public:
+                 recorder(bool want_read = true, bool want_write = false);
+                 ~recorder() throw ();
+  void           error(com::centreon::handle& h);
+  void           read(com::centreon::handle& h);
+  bool           want_read(com::centreon::handle& h);
+  bool           want_write(com::centreon::handle& h);
+  void           write(com::centreon::handle& h);
+
+  unsigned int   errors;
+  bool           read_interest;
+  unsigned int   reads;
+  bool           write_interest;
+  bool           write_once;
+  unsigned int   writes;
+};
+
+void             multiplex_once(
+                   com::centreon::connector::handle_manager& hm,
+                   com::centreon::task_manager& tm);
+
+#endif // !TEST_HANDLE_MANAGER_RECORDER_HH
@@ -0,0 +1,102 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include "com/centreon/clib.hh"
+#include "com/centreon/connector/handle_manager.hh"
+#include "com/centreon/task_manager.hh"
+#include "test/handle_manager/pipe_end.hh"
+#include "test/handle_manager/recorder.hh"
+
+using namespace com::centreon;
+
+/**
+ *  Check that removed handles are not dispatched anymore.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  clib::load();
+  int retval(EXIT_SUCCESS);
+  try {
+    task_manager tm;
+    connector::handle_manager hm(&tm);
+    pipe_end reader1;
+    pipe_end writer1;
+    pipe_end::open(reader1, writer1);
+    pipe_end reader2;
+    pipe_end writer2;
+    pipe_end::open(reader2, writer2);
+    recorder rec;
+
+    // Remove by handle.
+    hm.add(&reader1, &rec);
+    if (!hm.remove(&reader1) || hm.remove(&reader1)) {
+      std::cerr << "invalid return value of remove(handle*)" << std::endl;
+      retval = EXIT_FAILURE;
+    }
+    writer1.write("x", 1);
+    multiplex_once(hm, tm);
+    if (rec.reads) {
+      std::cerr << "removed handle was dispatched" << std::endl;
+      retval = EXIT_FAILURE;
+    }
+
+    // Remove by listener.
+    hm.add(&reader1, &rec);
+    hm.add(&reader2, &rec);
+    unsigned int removed(hm.remove(&rec));
+    if (removed != 2) {
+      std::cerr << "remove(handle_listener*) removed " << removed
+                << " handles instead of 2" << std::endl;
+      retval = EXIT_FAILURE;
+    }
+    writer2.write("x", 1);
+    multiplex_once(hm, tm);
+    if (rec.reads) {
+      std::cerr << "handle removed with its listener was dispatched"
+                << std::endl;
+      retval = EXIT_FAILURE;
+    }
+
+    // A handle closed without being removed does not prevent the
+    // registration of a new handle using the same descriptor.
+    hm.add(&reader1, &rec);
+    reader1.close();
+    writer1.close();
+    pipe_end reader3;
+    pipe_end writer3;
+    pipe_end::open(reader3, writer3);
+    hm.add(&reader3, &rec);
+    writer3.write("x", 1);
+    multiplex_once(hm, tm);
+    if (rec.reads != 1) {
+      std::cerr << "handle reusing a descriptor was read " << rec.reads
+                << " times instead of 1" << std::endl;
+      retval = EXIT_FAILURE;
+    }
+    hm.remove(&rec);
+  }
+  catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    retval = EXIT_FAILURE;
+  }
+  clib::unload();
+  return (retval);
+}
@@ -0,0 +1,93 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include "com/centreon/clib.hh"
+#include "com/centreon/connector/handle_manager.hh"
+#include "com/centreon/task_manager.hh"
+#include "test/handle_manager/pipe_end.hh"
+#include "test/handle_manager/recorder.hh"
+
+using namespace com::centreon;
+
+/**
+ *  Check that a change of interest made outside of a dispatch is only
+ *  taken into account after update(), and that interest is evaluated
+ *  again after each dispatch.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  clib::load();
+  int retval(EXIT_SUCCESS);
+  try {
+    task_manager tm;
+    connector::handle_manager hm(&tm);
+    pipe_end reader;
+    pipe_end writer;
+    pipe_end::open(reader, writer);
+    recorder rec(false, false);
+    rec.write_once = true;
+
+    // No interest.
+    hm.add(&writer, &rec);
+    multiplex_once(hm, tm);
+    if (rec.writes) {
+      std::cerr << "handle with no interest was dispatched"
+                << std::endl;
+      retval = EXIT_FAILURE;
+    }
+
+    // Interest changed outside of a dispatch, not notified.
+    rec.write_interest = true;
+    multiplex_once(hm, tm);
+    if (rec.writes) {
+      std::cerr << "interest was evaluated without update()"
+                << std::endl;
+      retval = EXIT_FAILURE;
+    }
+
+    // Interest changed outside of a dispatch, notified.
+    hm.update(&writer);
+    multiplex_once(hm, tm);
+    if (rec.writes != 1) {
+      std::cerr << "writable pipe was written " << rec.writes
+                << " times instead of 1 after update()" << std::endl;
+      retval = EXIT_FAILURE;
+    }
+
+    // Interest dropped by the write callback.
+    multiplex_once(hm, tm);
+    if (rec.writes != 1) {
+      std::cerr << "interest was not evaluated after dispatch"
+                << std::endl;
+      retval = EXIT_FAILURE;
+    }
+
+    // Unknown handles are ignored.
+    hm.update(&reader);
+    hm.remove(&writer);
+  }
+  catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    retval = EXIT_FAILURE;
+  }
+  clib::unload();
+  return (retval);
+}
@@ -27,6 +27,9 @@
 
 CCCP_BEGIN()
 
+// Forward declaration.
+class                  zygote;
+
 namespace              checks {
   // Forward declarations.
   class                listener;
@@ -37,6 +40,9 @@ namespace              checks {
    *  @brief Perl check.
    *
    *  Class wrapping a Perl check as requested by the monitoring engine.
+   *  The check either runs in its own process right away (execute())
+   *  or is queued (queue()) until it is started or run by a worker
+   *  process of a worker_pool.
    */
   class                check : public handle_listener {
   public:
@@ -46,11 +52,23 @@ namespace              checks {
     pid_t              execute(
                          unsigned long long cmd_id,
                          std::string const& cmd,
-                         time_t tmt);
+                         time_t tmt,
+                         zygote* forker = NULL);
+    void               failed(std::string const& msg = "");
+    unsigned long long get_command_id() const throw ();
     void               listen(listener* listnr);
     void               on_timeout(bool final = true);
+    void               queue(unsigned long long cmd_id, time_t tmt);
     void               read(handle& h);
+    pid_t              start(
+                         std::string const& cmd,
+                         zygote* forker = NULL);
+    void               started(pid_t child);
     void               terminated(int exit_code);
+    void               terminated(
+                         int exit_code,
+                         std::string const& output,
+                         std::string const& error);
     void               unlisten(listener* listnr);
     bool               want_read(handle& h);
     void               write(handle& h);
@@ -58,6 +76,7 @@ namespace              checks {
   private:
                        check(check const& c);
     check&             operator=(check const& c);
+    void               _schedule_timeout(time_t tmt);
     void               _send_result_and_unregister(result const& r);
 
     pid_t              _child;
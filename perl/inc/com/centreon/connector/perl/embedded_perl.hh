@@ -21,6 +21,8 @@
 
 #  include "com/centreon/connector/perl/namespace.hh"
 #  include "com/centreon/unordered_hash.hh"
+#  include <ctime>
+#  include <list>
 #  include <string>
 #  include <sys/types.h>
 #  include <EXTERN.h>
@@ -35,33 +37,74 @@ CCCP_BEGIN()
  *  @class embedded_perl embedded_perl.hh "com/centreon/connector/perl/embedded_perl.hh"
  *  @brief Embedded Perl interpreter.
  *
- *  Embedded Perl interpreter wrapped in a singleton.
+ *  Embedded Perl interpreter wrapped in a singleton. Scripts are
+ *  either run in a forked process (run()) or within the current
+ *  process (execute()), which is what pre-forked workers do.
+ *
+ *  Compiled scripts are cached. A script is recompiled when it is
+ *  modified, which is notified by inotify on its directory (or checked
+ *  with stat() when it cannot be watched). When the cache exceeds its
+ *  budget, least recently used scripts are released.
  */
 class                      embedded_perl {
 public:
                            ~embedded_perl();
+  int                      execute(
+                             std::string const& cmd,
+                             int out_fd,
+                             int err_fd);
   static embedded_perl&    instance();
   static void              load(
                              int* argc,
                              char*** argv,
                              char*** env,
-                             char const* code = NULL);
+                             char const* code = NULL,
+                             unsigned long cache_size = 0);
   pid_t                    run(std::string const& cmd, int fds[3]);
+  void                     trap_exit();
   static void              unload();
 
 private:
+  struct                   script {
+    dev_t                    device;
+    SV*                      handle;
+    ino_t                    inode;
+    std::list<std::string>::iterator
+                             lru;
+    time_t                   mtime;
+    off_t                    size;
+    bool                     watched;
+  };
+
                            embedded_perl(
                              int* argc,
                              char*** argv,
                              char*** env,
-                             char const* code = NULL);
+                             char const* code = NULL,
+                             unsigned long cache_size = 0);
                            embedded_perl(embedded_perl const& ep);
   embedded_perl&           operator=(embedded_perl const& ep);
+  SV*                      _compile(std::string const& file);
+  void                     _evict(std::string const& file);
+  void                     _read_events();
+  static void              _split(
+                             std::string const& cmd,
+                             std::string& file,
+                             std::string& args);
+  void                     _unwatch_all();
+  bool                     _watch(std::string const& file);
   void                     _write(char const* data, size_t len);
 
-  umap<std::string, SV*>   _parsed;
+  unsigned long            _cache_size;
+  unsigned long            _cached_size;
+  int                      _inotify_fd;
+  pid_t                    _inotify_owner;
+  std::list<std::string>   _lru;
+  umap<std::string, script>
+                           _parsed;
   static char const* const _script;
   pid_t                    _self;
+  umap<int, std::string>   _watches;
 };
 
 CCCP_END()
@@ -19,8 +19,8 @@
 #ifndef CCCP_MULTIPLEXER_HH
 #  define CCCP_MULTIPLEXER_HH
 
-#  include "com/centreon/handle_manager.hh"
 #  include "com/centreon/task_manager.hh"
+#  include "com/centreon/connector/handle_manager.hh"
 #  include "com/centreon/connector/perl/namespace.hh"
 
 CCCP_BEGIN()
@@ -34,7 +34,7 @@ CCCP_BEGIN()
  */
 class                 multiplexer
   : public com::centreon::task_manager,
-    public com::centreon::handle_manager {
+    public com::centreon::connector::handle_manager {
 public:
                       ~multiplexer() throw ();
   static multiplexer& instance() throw ();
@@ -36,11 +36,24 @@ public:
               options(options const& opts);
               ~options() throw ();
   options&    operator=(options const& opts);
+  unsigned int
+              get_max_concurrent_checks() const;
+  unsigned long
+              get_script_cache_size() const;
+  unsigned int
+              get_worker_max_jobs() const;
+  unsigned long
+              get_worker_max_memory() const;
+  unsigned int
+              get_workers() const;
+  bool        get_zygote() const;
   std::string help() const;
   void        parse(int argc, char* argv[]);
   std::string usage() const;
 
 private:
+  unsigned int
+              _get_unsigned(char name, unsigned int default_value) const;
   void        _init();
 };
 
@@ -19,12 +19,16 @@
 #ifndef CCCP_POLICY_HH
 #  define CCCP_POLICY_HH
 
+#  include <ctime>
 #  include <map>
+#  include <memory>
+#  include <string>
 #  include <sys/types.h>
 #  include "com/centreon/connector/perl/checks/listener.hh"
 #  include "com/centreon/connector/perl/namespace.hh"
 #  include "com/centreon/connector/perl/orders/listener.hh"
 #  include "com/centreon/connector/perl/orders/parser.hh"
+#  include "com/centreon/connector/perl/reaper.hh"
 #  include "com/centreon/connector/perl/reporter.hh"
 #  include "com/centreon/io/file_stream.hh"
 
@@ -35,17 +39,23 @@ namespace         checks {
   class           check;
   class           result;
 }
+class             options;
+class             worker_pool;
+class             zygote;
 
 /**
  *  @class policy policy.hh "com/centreon/connector/perl/policy.hh"
  *  @brief Software policy.
  *
- *  Wraps software policy within a class.
+ *  Wraps software policy within a class. Checks run in their own
+ *  process, forked by the connector or by a zygote process, or in a
+ *  pool of pre-forked worker processes. When the maximum number of
+ *  running checks is reached, checks wait by earliest deadline.
  */
 class             policy : public orders::listener,
                            public checks::listener {
 public:
-                  policy();
+                  policy(options const& opts);
                   ~policy() throw ();
   void            on_eof();
   void            on_error();
@@ -59,16 +69,32 @@ public:
   bool            run();
 
 private:
+  struct          queued_check {
+    checks::check*  chk;
+    std::string     cmd;
+  };
+
                   policy(policy const& p);
   policy&         operator=(policy const& p);
+  void            _purge_queue();
+  void            _start_queued();
+  pid_t           _wait(int* status);
 
   std::map<pid_t, checks::check*>
                   _checks;
   bool            _error;
+  unsigned int    _max_concurrent_checks;
   orders::parser  _parser;
+  std::auto_ptr<worker_pool>
+                  _pool;
+  std::multimap<time_t, queued_check>
+                  _queue;
+  reaper          _reaper;
   reporter        _reporter;
   io::file_stream _sin;
   io::file_stream _sout;
+  std::auto_ptr<zygote>
+                  _zygote;
 };
 
 CCCP_END()
@@ -0,0 +1,64 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCP_REAPER_HH
+#  define CCCP_REAPER_HH
+
+#  include <list>
+#  include <signal.h>
+#  include <sys/types.h>
+#  include <utility>
+#  include "com/centreon/connector/perl/namespace.hh"
+#  include "com/centreon/connector/perl/pipe_handle.hh"
+#  include "com/centreon/handle_listener.hh"
+
+CCCP_BEGIN()
+
+/**
+ *  @class reaper reaper.hh "com/centreon/connector/perl/reaper.hh"
+ *  @brief Reap child processes as soon as they terminate.
+ *
+ *  SIGCHLD is blocked and read from a signalfd registered with the
+ *  multiplexer. Children are only reaped when this descriptor is
+ *  readable, so that a multiplexing iteration does not cost any
+ *  waitpid() call when no child terminated. Forked processes must
+ *  restore the signal mask with unblock().
+ */
+class              reaper : public handle_listener {
+public:
+                   reaper();
+                   ~reaper() throw ();
+  void             error(handle& h);
+  void             read(handle& h);
+  static void      unblock();
+  pid_t            wait(int* status);
+  bool             want_read(handle& h);
+
+private:
+                   reaper(reaper const& r);
+  reaper&          operator=(reaper const& r);
+
+  std::list<std::pair<pid_t, int> >
+                   _exited;
+  sigset_t         _old_mask;
+  pipe_handle      _signal;
+};
+
+CCCP_END()
+
+#endif // !CCCP_REAPER_HH
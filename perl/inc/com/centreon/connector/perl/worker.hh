@@ -0,0 +1,89 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCP_WORKER_HH
+#  define CCCP_WORKER_HH
+
+#  include <string>
+#  include <sys/types.h>
+#  include "com/centreon/connector/perl/namespace.hh"
+#  include "com/centreon/connector/perl/pipe_handle.hh"
+#  include "com/centreon/handle_listener.hh"
+
+CCCP_BEGIN()
+
+// Forward declarations.
+namespace            checks {
+  class              check;
+}
+class                worker_pool;
+
+/**
+ *  @class worker worker.hh "com/centreon/connector/perl/worker.hh"
+ *  @brief Pre-forked process that runs checks.
+ *
+ *  The worker process keeps the scripts it compiled and runs checks
+ *  one after the other within its own interpreter. Commands are sent
+ *  over a UNIX socket, the worker replies with the exit code and the
+ *  output of the script. A worker exits on its own once it ran its
+ *  maximum number of checks or its memory grew too much.
+ */
+class                worker : public handle_listener {
+public:
+                     worker(
+                       worker_pool* pool,
+                       unsigned int max_jobs,
+                       unsigned long max_memory);
+                     ~worker() throw ();
+  void               error(handle& h);
+  void               execute(
+                       checks::check* chk,
+                       std::string const& cmd);
+  checks::check*     get_check() const throw ();
+  unsigned int       get_jobs() const throw ();
+  pid_t              get_pid() const throw ();
+  bool               is_retired() const throw ();
+  void               read(handle& h);
+  void               terminated(int status);
+  bool               want_read(handle& h);
+  bool               want_write(handle& h);
+  void               write(handle& h);
+
+private:
+                     worker(worker const& w);
+  worker&            operator=(worker const& w);
+  void               _close();
+  bool               _parse_reply();
+  static void        _serve(
+                       int fd,
+                       unsigned int max_jobs,
+                       unsigned long max_memory);
+
+  std::string        _rbuffer;
+  checks::check*     _check;
+  unsigned int       _jobs;
+  pid_t              _pid;
+  worker_pool*       _pool;
+  bool               _retired;
+  pipe_handle        _socket;
+  std::string        _wbuffer;
+};
+
+CCCP_END()
+
+#endif // !CCCP_WORKER_HH
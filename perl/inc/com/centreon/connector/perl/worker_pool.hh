@@ -0,0 +1,86 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCP_WORKER_POOL_HH
+#  define CCCP_WORKER_POOL_HH
+
+#  include <list>
+#  include <map>
+#  include <string>
+#  include <ctime>
+#  include <sys/types.h>
+#  include <utility>
+#  include "com/centreon/connector/perl/namespace.hh"
+#  include "com/centreon/task.hh"
+
+CCCP_BEGIN()
+
+// Forward declarations.
+namespace           checks {
+  class             check;
+}
+class               worker;
+
+/**
+ *  @class worker_pool worker_pool.hh "com/centreon/connector/perl/worker_pool.hh"
+ *  @brief Pool of pre-forked worker processes.
+ *
+ *  Checks are given to idle workers or wait for one by earliest
+ *  deadline. Workers that exit are replaced, with an increasing delay
+ *  when they keep dying before completing any check. The pool owns the
+ *  checks it was given.
+ */
+class               worker_pool : public com::centreon::task {
+public:
+                    worker_pool(
+                      unsigned int size,
+                      unsigned int max_jobs,
+                      unsigned long max_memory);
+                    ~worker_pool() throw ();
+  void              execute(
+                      checks::check* chk,
+                      std::string const& cmd,
+                      time_t deadline);
+  bool              is_busy() const;
+  void              on_idle(worker* w);
+  void              run();
+  bool              terminated(pid_t pid, int status);
+
+private:
+                    worker_pool(worker_pool const& wp);
+  worker_pool&      operator=(worker_pool const& wp);
+  void              _dispatch();
+  void              _replace();
+  void              _spawn();
+
+  unsigned int      _early_deaths;
+  std::list<worker*>
+                    _idle;
+  unsigned int      _max_jobs;
+  unsigned long     _max_memory;
+  std::multimap<time_t, std::pair<checks::check*, std::string> >
+                    _pending;
+  unsigned long     _respawn;
+  unsigned int      _size;
+  std::map<pid_t, worker*>
+                    _workers;
+};
+
+CCCP_END()
+
+#endif // !CCCP_WORKER_POOL_HH
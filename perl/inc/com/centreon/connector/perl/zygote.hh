@@ -0,0 +1,68 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCP_ZYGOTE_HH
+#  define CCCP_ZYGOTE_HH
+
+#  include <list>
+#  include <string>
+#  include <sys/types.h>
+#  include <utility>
+#  include "com/centreon/connector/perl/namespace.hh"
+#  include "com/centreon/connector/perl/pipe_handle.hh"
+#  include "com/centreon/handle_listener.hh"
+
+CCCP_BEGIN()
+
+/**
+ *  @class zygote zygote.hh "com/centreon/connector/perl/zygote.hh"
+ *  @brief Fork server of check processes.
+ *
+ *  Small process forked at startup that only holds the Perl
+ *  interpreter and its compiled scripts. It forks check processes on
+ *  behalf of the connector and hands their pipes back over a UNIX
+ *  socket (SCM_RIGHTS). Check processes are children of the zygote,
+ *  which reports their exit status on a second socket.
+ */
+class              zygote : public handle_listener {
+public:
+                   zygote();
+                   ~zygote() throw ();
+  void             error(handle& h);
+  pid_t            get_pid() const throw ();
+  void             read(handle& h);
+  pid_t            run(std::string const& cmd, int fds[3]);
+  pid_t            wait(int* status);
+  bool             want_read(handle& h);
+
+private:
+                   zygote(zygote const& z);
+  zygote&          operator=(zygote const& z);
+  static void      _serve(int requests, int statuses);
+
+  std::string      _buffer;
+  std::list<std::pair<pid_t, int> >
+                   _exited;
+  pid_t            _pid;
+  pipe_handle      _requests;
+  pipe_handle      _statuses;
+};
+
+CCCP_END()
+
+#endif // !CCCP_ZYGOTE_HH
@@ -25,6 +25,7 @@
 #include "com/centreon/connector/perl/checks/timeout.hh"
 #include "com/centreon/connector/perl/embedded_perl.hh"
 #include "com/centreon/connector/perl/multiplexer.hh"
+#include "com/centreon/connector/perl/zygote.hh"
 #include "com/centreon/logging/logger.hh"
 
 using namespace com::centreon;
@@ -74,45 +75,53 @@ void check::error(handle& h) {
  *  @param[in] cmd_id Command ID.
  *  @param[in] cmd    Command line.
  *  @param[in] tmt    Timeout.
+ *  @param[in] forker Zygote that forks the process, NULL to fork it
+ *                    from the current process.
  *
  *  @return Process ID.
  */
 pid_t check::execute(
                unsigned long long cmd_id,
                std::string const& cmd,
-               time_t tmt) {
+               time_t tmt,
+               zygote* forker) {
   // Run process.
-  int fds[3];
-  _child = embedded_perl::instance().run(cmd, fds);
-  ::close(fds[0]);
-  _out.set_fd(fds[1]);
-  _err.set_fd(fds[2]);
+  start(cmd, forker);
 
   // Store command ID.
   log_debug(logging::low) << "check " << this
     << " has ID " << cmd_id;
   _cmd_id = cmd_id;
 
-  // Register with multiplexer.
-  multiplexer::instance().handle_manager::add(
-    &_err,
-    this);
-  multiplexer::instance().handle_manager::add(
-    &_out,
-    this);
-
   // Register timeout.
-  std::auto_ptr<timeout> t(new timeout(this, false));
-  _timeout = multiplexer::instance().com::centreon::task_manager::add(
-    t.get(),
-    tmt - 1,
-    false,
-    true);
-  t.release();
+  _schedule_timeout(tmt);
 
   return (_child);
 }
 
+/**
+ *  Report that the check could not be executed.
+ *
+ *  @param[in] msg Error message.
+ */
+void check::failed(std::string const& msg) {
+  _child = (pid_t)-1;
+  result r;
+  r.set_command_id(_cmd_id);
+  r.set_error(msg);
+  _send_result_and_unregister(r);
+  return ;
+}
+
+/**
+ *  Get the command ID.
+ *
+ *  @return Command ID, 0 once the check result was sent.
+ */
+unsigned long long check::get_command_id() const throw () {
+  return (_cmd_id);
+}
+
 /**
  *  Listen the check.
  *
@@ -138,8 +147,15 @@ void check::on_timeout(bool final) {
   // Reset timeout task ID.
   _timeout = 0;
 
-  if (_child <= 0)
+  // Check is still waiting for a worker.
+  if (_child <= 0) {
+    if (_cmd_id) {
+      result r;
+      r.set_command_id(_cmd_id);
+      _send_result_and_unregister(r);
+    }
     return ;
+  }
 
   if (final) {
     // Send SIGKILL (not catchable, not ignorable).
@@ -162,6 +178,24 @@ void check::on_timeout(bool final) {
   return ;
 }
 
+/**
+ *  @brief Queue the check.
+ *
+ *  The check is run later, either by start() or by a worker process
+ *  that will call started() and terminated(). If its timeout expires
+ *  meanwhile, the check is answered as not executed.
+ *
+ *  @param[in] cmd_id Command ID.
+ *  @param[in] tmt    Timeout.
+ */
+void check::queue(unsigned long long cmd_id, time_t tmt) {
+  log_debug(logging::low) << "check " << this
+    << " has ID " << cmd_id;
+  _cmd_id = cmd_id;
+  _schedule_timeout(tmt);
+  return ;
+}
+
 /**
  *  Read data from handle.
  *
@@ -183,6 +217,46 @@ void check::read(handle& h) {
   return ;
 }
 
+/**
+ *  Run the process of a check previously queued with queue().
+ *
+ *  @param[in] cmd    Command line.
+ *  @param[in] forker Zygote that forks the process, NULL to fork it
+ *                    from the current process.
+ *
+ *  @return Process ID.
+ */
+pid_t check::start(std::string const& cmd, zygote* forker) {
+  // Run process.
+  int fds[3];
+  _child = (forker
+            ? forker->run(cmd, fds)
+            : embedded_perl::instance().run(cmd, fds));
+  ::close(fds[0]);
+  _out.set_fd(fds[1]);
+  _err.set_fd(fds[2]);
+
+  // Register with multiplexer.
+  multiplexer::instance().handle_manager::add(
+    &_err,
+    this);
+  multiplexer::instance().handle_manager::add(
+    &_out,
+    this);
+
+  return (_child);
+}
+
+/**
+ *  A worker process started to run the check.
+ *
+ *  @param[in] child Worker process ID.
+ */
+void check::started(pid_t child) {
+  _child = child;
+  return ;
+}
+
 /**
  *  Process termination callback.
  *
@@ -226,6 +300,30 @@ void check::terminated(int exit_code) {
   return ;
 }
 
+/**
+ *  Check termination callback with already read output.
+ *
+ *  @param[in] exit_code Script exit code.
+ *  @param[in] output    Script standard output.
+ *  @param[in] error     Script standard error.
+ */
+void check::terminated(
+              int exit_code,
+              std::string const& output,
+              std::string const& error) {
+  _child = (pid_t)-1;
+  _stdout.append(output);
+  _stderr.append(error);
+  result r;
+  r.set_command_id(_cmd_id);
+  r.set_executed(true);
+  r.set_exit_code(exit_code);
+  r.set_error(_stderr);
+  r.set_output(_stdout);
+  _send_result_and_unregister(r);
+  return ;
+}
+
 /**
  *  Unlisten the check.
  *
@@ -268,6 +366,22 @@ void check::write(handle& h) {
 *                                     *
 **************************************/
 
+/**
+ *  Register the timeout of the check.
+ *
+ *  @param[in] tmt Timeout.
+ */
+void check::_schedule_timeout(time_t tmt) {
+  std::auto_ptr<timeout> t(new timeout(this, false));
+  _timeout = multiplexer::instance().com::centreon::task_manager::add(
+    t.get(),
+    tmt - 1,
+    false,
+    true);
+  t.release();
+  return ;
+}
+
 /**
  *  Send check result and unregister.
  *
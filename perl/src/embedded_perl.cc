@@ -16,14 +16,19 @@
 ** For more information : contact@centreon.com
 */
 
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <list>
+#include <sys/inotify.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <EXTERN.h>
 #include <perl.h>
 #include "com/centreon/connector/perl/embedded_perl.hh"
 #include "com/centreon/connector/perl/pipe_handle.hh"
+#include "com/centreon/connector/perl/reaper.hh"
 #include "com/centreon/exceptions/basic.hh"
 #include "com/centreon/logging/logger.hh"
 
@@ -32,6 +37,9 @@ using namespace com::centreon::connector::perl;
 
 // Temporary script path.
 #define SCRIPT_PATH "/tmp/centreon_connector_perl.XXXXXX"
+// Directory events that invalidate compiled scripts.
+#define WATCH_EVENTS (IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE \
+                      | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR)
 
 // Embedded Perl instance.
 static embedded_perl* _instance = NULL;
@@ -53,6 +61,10 @@ EXTERN_C void xs_init(pTHX);
 embedded_perl::~embedded_perl() {
   // Clean only if within parent process.
   if (_self == getpid()) {
+    // Release compiled scripts.
+    while (!_lru.empty())
+      _evict(_lru.back());
+
     // Clean Perl interpreter.
     log_info(logging::low) << "cleaning up Embedded Perl";
     if (my_perl) {
@@ -62,9 +74,89 @@ embedded_perl::~embedded_perl() {
       PERL_SYS_TERM();
     }
   }
+  if ((_inotify_fd >= 0) && (_inotify_owner == getpid()))
+    close(_inotify_fd);
   return ;
 }
 
+/**
+ *  @brief Run a Perl script within the current process.
+ *
+ *  The script output is written to the given descriptors. exit() must
+ *  have been trapped with trap_exit() before the script was compiled,
+ *  otherwise the script terminates the current process.
+ *
+ *  @param[in] cmd    Command to execute.
+ *  @param[in] out_fd Descriptor that receives the script's stdout.
+ *  @param[in] err_fd Descriptor that receives the script's stderr.
+ *
+ *  @return Script exit code.
+ */
+int embedded_perl::execute(
+                     std::string const& cmd,
+                     int out_fd,
+                     int err_fd) {
+  // Compile Perl file.
+  std::string args;
+  std::string file;
+  _split(cmd, file, args);
+  SV* handle(_compile(file));
+
+  // Redirect standard outputs.
+  int saved_err(dup(STDERR_FILENO));
+  int saved_out(dup(STDOUT_FILENO));
+  if ((saved_err < 0)
+      || (saved_out < 0)
+      || (dup2(out_fd, STDOUT_FILENO) < 0)
+      || (dup2(err_fd, STDERR_FILENO) < 0)) {
+    char const* msg(strerror(errno));
+    if (saved_err >= 0) {
+      dup2(saved_err, STDERR_FILENO);
+      close(saved_err);
+    }
+    if (saved_out >= 0) {
+      dup2(saved_out, STDOUT_FILENO);
+      close(saved_out);
+    }
+    throw (basic_error() << "could not redirect script output: "
+           << msg);
+  }
+
+  // Run check.
+  int exit_code(3);
+  {
+    dSP;
+    ENTER;
+    SAVETMPS;
+    PUSHMARK(SP);
+    XPUSHs(sv_2mortal(newSVpv(file.c_str(), 0)));
+    XPUSHs(handle);
+    XPUSHs(sv_2mortal(newSVpv(args.c_str(), 0)));
+    PUTBACK;
+    call_pv("Embed::Persistent::run_file", G_EVAL | G_DISCARD);
+    SV* err(ERRSV);
+    if (SvROK(err) && sv_derived_from(err, "Embed::Persistent::Exit")) {
+      SV** code(hv_fetch((HV*)SvRV(err), "code", 4, 0));
+      exit_code = (code ? (SvIV(*code) & 0xFF) : 0);
+    }
+    else
+      std::cerr << "error while executing Perl script '" << file
+                << "': " << SvPV_nolen(err) << std::endl;
+    FREETMPS;
+    LEAVE;
+  }
+  PerlIO_flush(PerlIO_stdout());
+  PerlIO_flush(PerlIO_stderr());
+
+  // Restore standard outputs.
+  dup2(saved_err, STDERR_FILENO);
+  close(saved_err);
+  dup2(saved_out, STDOUT_FILENO);
+  close(saved_out);
+
+  return (exit_code);
+}
+
 /**
  *  Get instance.
  *
@@ -77,18 +169,21 @@ embedded_perl& embedded_perl::instance() {
 /**
  *  Load Embedded Perl.
  *
- *  @param[in] argc Argument count.
- *  @param[in] argv Argument values.
- *  @param[in] env  Program environment.
- *  @param[in] code Additional code to run by interpreter.
+ *  @param[in] argc       Argument count.
+ *  @param[in] argv       Argument values.
+ *  @param[in] env        Program environment.
+ *  @param[in] code       Additional code to run by interpreter.
+ *  @param[in] cache_size Size of the compiled scripts cache in bytes,
+ *                        0 if unlimited.
  */
 void embedded_perl::load(
                       int* argc,
                       char*** argv,
                       char*** env,
-                      char const* code) {
+                      char const* code,
+                      unsigned long cache_size) {
   if (!_instance)
-    _instance = new embedded_perl(argc, argv, env, code);
+    _instance = new embedded_perl(argc, argv, env, code, cache_size);
   return ;
 }
 
@@ -106,52 +201,12 @@ pid_t embedded_perl::run(std::string const& cmd, int fds[3]) {
     throw (basic_error() << "cannot run Perl script without " \
              "fetching process' descriptors");
 
-  // Extract arguments.
-  size_t pos(cmd.find(' '));
+  // Compile Perl file.
   std::string args;
   std::string file;
-  if (pos != std::string::npos) {
-    file = cmd.substr(0, pos);
-    args = cmd.substr(pos + 1);
-  }
-  else
-    file = cmd;
-  log_debug(logging::medium)
-    << "command " << cmd << "\n"
-    << "  - file " << file << "\n"
-    << "  - args " << args;
-
-  // Check if file has already been compiled.
-  SV* handle;
-  umap<std::string, SV*>::const_iterator it(_parsed.find(file));
+  _split(cmd, file, args);
+  SV* handle(_compile(file));
   dSP;
-  if (it == _parsed.end()) {
-    // Compile Perl file.
-    {
-      log_debug(logging::medium) << "parsing file " << file;
-      char const* argv[3];
-      argv[0] = file.c_str();
-      argv[1] = "0";
-      argv[2] = NULL;
-      if (call_argv(
-            "Embed::Persistent::eval_file",
-	    G_EVAL | G_SCALAR,
-	    (char**)argv)
-	  != 1)
-	throw (basic_error() << "could not compile Perl script " << file);
-    }
-    SPAGAIN;
-    handle = POPs;
-    if (SvTRUE(ERRSV))
-      throw (basic_error() << "Embedded Perl error: "
-	     << SvPV_nolen(ERRSV));
-
-    // Insert in parsed file list.
-    _parsed.insert(std::make_pair(file, handle));
-  }
-  // Already parsed.
-  else
-    handle = it->second;
 
   // Open pipes.
   int in_pipe[2];
@@ -200,6 +255,9 @@ pid_t embedded_perl::run(std::string const& cmd, int fds[3]) {
       std::cerr << "could not close all inherited FDs" << std::endl;
       exit(3);
     }
+    if (_inotify_fd >= 0)
+      close(_inotify_fd);
+    reaper::unblock();
 
     // Setup process.
     close(in_pipe[1]);
@@ -258,6 +316,19 @@ pid_t embedded_perl::run(std::string const& cmd, int fds[3]) {
   return (child);
 }
 
+/**
+ *  @brief Trap exit() calls of scripts compiled from now on.
+ *
+ *  Scripts run by execute() then return their exit code instead of
+ *  terminating the process.
+ */
+void embedded_perl::trap_exit() {
+  dSP;
+  PUSHMARK(SP);
+  call_pv("Embed::Persistent::trap_exit", G_DISCARD | G_NOARGS);
+  return ;
+}
+
 /**
  *  Unload Embedded Perl.
  */
@@ -273,19 +344,287 @@ void embedded_perl::unload() {
 *                                     *
 **************************************/
 
+/**
+ *  Compile a Perl file if it was not already or if it was modified
+ *  since it was compiled.
+ *
+ *  @param[in] file Path to the Perl file.
+ *
+ *  @return Handle of the compiled script.
+ */
+SV* embedded_perl::_compile(std::string const& file) {
+  // Drop scripts modified since they were compiled.
+  _read_events();
+
+  // Already parsed.
+  struct stat st;
+  umap<std::string, script>::iterator it(_parsed.find(file));
+  if (it != _parsed.end()) {
+    // A script that was not watched might have been modified, the new
+    // watch is only trusted from the next run on.
+    script& s(it->second);
+    bool was_watched(s.watched);
+    if (!was_watched)
+      s.watched = _watch(file);
+    if (was_watched
+        || (!stat(file.c_str(), &st)
+            && (st.st_dev == s.device)
+            && (st.st_ino == s.inode)
+            && (st.st_mtime == s.mtime)
+            && (st.st_size == s.size))) {
+      _lru.splice(_lru.begin(), _lru, s.lru);
+      return (s.handle);
+    }
+    log_info(logging::low) << "script " << file
+      << " was modified and will be compiled again";
+    _evict(file);
+  }
+
+  // Watch file before reading it so that no modification is missed.
+  bool watched(_watch(file));
+  if (stat(file.c_str(), &st))
+    memset(&st, 0, sizeof(st));
+
+  // Compile Perl file.
+  SV* handle(NULL);
+  std::string error;
+  {
+    dSP;
+    ENTER;
+    SAVETMPS;
+    log_debug(logging::medium) << "parsing file " << file;
+    char const* argv[3];
+    argv[0] = file.c_str();
+    argv[1] = "0";
+    argv[2] = NULL;
+    int count(call_argv(
+                "Embed::Persistent::eval_file",
+                G_EVAL | G_SCALAR,
+                (char**)argv));
+    SPAGAIN;
+    if (count != 1)
+      error = "could not compile Perl script " + file;
+    else if (SvTRUE(ERRSV)) {
+      error = "Embedded Perl error: ";
+      error.append(SvPV_nolen(ERRSV));
+      (void)POPs;
+    }
+    else
+      handle = newSVsv(POPs);
+    PUTBACK;
+    FREETMPS;
+    LEAVE;
+  }
+  if (!handle)
+    throw (basic_error() << error);
+
+  // Insert in parsed file list.
+  script& s(_parsed[file]);
+  s.device = st.st_dev;
+  s.handle = handle;
+  s.inode = st.st_ino;
+  _lru.push_front(file);
+  s.lru = _lru.begin();
+  s.mtime = st.st_mtime;
+  s.size = st.st_size;
+  s.watched = watched;
+  _cached_size += s.size;
+
+  // Release least recently used scripts.
+  while (_cache_size
+         && (_cached_size > _cache_size)
+         && (_lru.size() > 1)) {
+    log_debug(logging::medium) << "releasing compiled script "
+      << _lru.back();
+    _evict(_lru.back());
+  }
+  return (handle);
+}
+
+/**
+ *  Release a compiled script.
+ *
+ *  @param[in] file Path to the Perl file.
+ */
+void embedded_perl::_evict(std::string const& file) {
+  // file might be an element of _lru.
+  std::string path(file);
+  umap<std::string, script>::iterator it(_parsed.find(path));
+  if (it == _parsed.end())
+    return ;
+  SV* handle(it->second.handle);
+  _cached_size -= it->second.size;
+  _lru.erase(it->second.lru);
+  _parsed.erase(it);
+
+  // Remove script from the interpreter.
+  dSP;
+  ENTER;
+  SAVETMPS;
+  PUSHMARK(SP);
+  XPUSHs(sv_2mortal(newSVpv(path.c_str(), 0)));
+  PUTBACK;
+  call_pv("Embed::Persistent::uncache_file", G_EVAL | G_DISCARD);
+  FREETMPS;
+  LEAVE;
+  SvREFCNT_dec(handle);
+  return ;
+}
+
+/**
+ *  @brief Read pending inotify events and release the scripts that
+ *  were modified.
+ *
+ *  An inotify instance is only read by the process that created it, a
+ *  forked process creates its own on first use.
+ */
+void embedded_perl::_read_events() {
+  if (_inotify_owner != getpid()) {
+    if (_inotify_fd >= 0)
+      close(_inotify_fd);
+    _watches.clear();
+    _inotify_owner = getpid();
+    _inotify_fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (_inotify_fd < 0) {
+      char const* msg(strerror(errno));
+      log_error(logging::low) << "could not watch Perl scripts, they "
+        "will be checked for modification on each run: " << msg;
+    }
+    _unwatch_all();
+  }
+  if (_inotify_fd < 0)
+    return ;
+
+  long buffer[4096 / sizeof(long)];
+  ssize_t rb;
+  while ((rb = read(_inotify_fd, buffer, sizeof(buffer))) > 0) {
+    for (char const* ptr((char const*)buffer), *end(ptr + rb);
+         ptr < end;) {
+      inotify_event const* event((inotify_event const*)ptr);
+      ptr += sizeof(*event) + event->len;
+
+      // Events were lost or a directory is not watched anymore.
+      if ((event->mask & IN_Q_OVERFLOW)
+          || ((event->mask & IN_IGNORED)
+              && _watches.erase(event->wd))) {
+        log_debug(logging::medium) << "Perl scripts will be checked "
+          "for modification on their next run";
+        _unwatch_all();
+      }
+      else if (event->len) {
+        umap<int, std::string>::const_iterator
+          it(_watches.find(event->wd));
+        if (it == _watches.end())
+          continue ;
+        std::string path(it->second);
+        path.append(event->name);
+        if (_parsed.find(path) != _parsed.end()) {
+          log_info(logging::low) << "script " << path
+            << " was modified and will be compiled again";
+          _evict(path);
+        }
+      }
+    }
+  }
+  return ;
+}
+
+/**
+ *  Split a command into file and arguments.
+ *
+ *  @param[in]  cmd  Command line.
+ *  @param[out] file Path to the Perl file.
+ *  @param[out] args Script arguments.
+ */
+void embedded_perl::_split(
+                      std::string const& cmd,
+                      std::string& file,
+                      std::string& args) {
+  size_t pos(cmd.find(' '));
+  if (pos != std::string::npos) {
+    file = cmd.substr(0, pos);
+    args = cmd.substr(pos + 1);
+  }
+  else {
+    file = cmd;
+    args.clear();
+  }
+  log_debug(logging::medium)
+    << "command " << cmd << "\n"
+    << "  - file " << file << "\n"
+    << "  - args " << args;
+  return ;
+}
+
+/**
+ *  Consider that no compiled script is watched anymore. They are then
+ *  checked with stat() and watched again on their next run.
+ */
+void embedded_perl::_unwatch_all() {
+  for (umap<std::string, script>::iterator
+         it(_parsed.begin()), end(_parsed.end());
+       it != end;
+       ++it)
+    it->second.watched = false;
+  return ;
+}
+
+/**
+ *  Watch the directory of a Perl file.
+ *
+ *  @param[in] file Path to the Perl file.
+ *
+ *  @return true if modifications of the file will be notified.
+ */
+bool embedded_perl::_watch(std::string const& file) {
+  if ((_inotify_fd < 0) || (_inotify_owner != getpid()))
+    return (false);
+
+  // The target of a symbolic link might live in another directory,
+  // events would only be reported for the link itself.
+  struct stat st;
+  if (!lstat(file.c_str(), &st) && S_ISLNK(st.st_mode))
+    return (false);
+
+  size_t pos(file.rfind('/'));
+  std::string prefix(
+                (pos == std::string::npos)
+                ? std::string()
+                : file.substr(0, pos + 1));
+  int wd(inotify_add_watch(
+           _inotify_fd,
+           (prefix.empty() ? "." : prefix.c_str()),
+           WATCH_EVENTS));
+  if (wd < 0) {
+    char const* msg(strerror(errno));
+    log_debug(logging::medium) << "could not watch script " << file
+      << ", it will be checked for modification on each run: " << msg;
+    return (false);
+  }
+  _watches[wd] = prefix;
+  return (true);
+}
+
 /**
  *  Constructor.
  *
- *  @param[in] argc Argument count.
- *  @param[in] argv Argument values.
- *  @param[in] env  Program environment.
- *  @param[in] code Additional code to run by interpreter.
+ *  @param[in] argc       Argument count.
+ *  @param[in] argv       Argument values.
+ *  @param[in] env        Program environment.
+ *  @param[in] code       Additional code to run by interpreter.
+ *  @param[in] cache_size Size of the compiled scripts cache in bytes,
+ *                        0 if unlimited.
  */
 embedded_perl::embedded_perl(
                  int* argc,
                  char*** argv,
                  char*** env,
-                 char const* code) {
+                 char const* code,
+                 unsigned long cache_size)
+  : _cache_size(cache_size),
+    _cached_size(0),
+    _inotify_fd(-1),
+    _inotify_owner(0) {
   // Do not warn if unused by PERL_SYS_INIT3 macro.
   (void)argc;
   (void)argv;
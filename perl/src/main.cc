@@ -140,10 +140,11 @@ int main(int argc, char** argv, char** env) {
                        &env,
                        (opts.get_argument("code").get_is_set()
                         ? opts.get_argument("code").get_value().c_str()
-                        : NULL));
+                        : NULL),
+                       opts.get_script_cache_size());
 
       // Program policy.
-      policy p;
+      policy p(opts);
       retval = (p.run() ? EXIT_SUCCESS : EXIT_FAILURE);
     }
   }
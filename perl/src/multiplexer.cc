@@ -72,4 +72,4 @@ void multiplexer::unload() {
  *  Default constructor.
  */
 multiplexer::multiplexer()
-  : com::centreon::handle_manager(this) {}
+  : handle_manager(this) {}
@@ -16,9 +16,14 @@
 ** For more information : contact@centreon.com
 */
 
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <sstream>
 #include "com/centreon/connector/perl/options.hh"
+#include "com/centreon/exceptions/basic.hh"
 
+using namespace com::centreon;
 using namespace com::centreon::connector::perl;
 
 // Options descriptions.
@@ -32,6 +37,18 @@ static char const* const version_description
   = "Print software version and exit.";
 static char const* const log_file_description
   = "Specifies the log file (default: stderr).";
+static char const* const max_concurrent_checks_description
+  = "Maximum number of checks running at the same time, others wait by earliest deadline (default: 0, unlimited).";
+static char const* const script_cache_size_description
+  = "Size in MiB of the source of the compiled scripts kept in memory, least recently used ones are released (default: 0, unlimited).";
+static char const* const worker_max_jobs_description
+  = "Number of checks after which a worker process is replaced (default: 1000, 0 means never).";
+static char const* const worker_max_memory_description
+  = "Memory growth in MiB after which a worker process is replaced (default: 0, never).";
+static char const* const zygote_description
+  = "Fork checks from a small dedicated process instead of the connector.";
+static char const* const workers_description
+  = "Number of pre-forked worker processes that execute checks (default: 0, fork a process per check).";
 
 /**************************************
 *                                     *
@@ -73,6 +90,62 @@ options& options::operator=(options const& opts) {
   return (*this);
 }
 
+/**
+ *  Get the maximum number of checks running at the same time.
+ *
+ *  @return Maximum number of running checks, 0 if unlimited.
+ */
+unsigned int options::get_max_concurrent_checks() const {
+  return (_get_unsigned('C', 0));
+}
+
+/**
+ *  Get the size of the compiled scripts cache.
+ *
+ *  @return Cache size in bytes, 0 if unlimited.
+ */
+unsigned long options::get_script_cache_size() const {
+  return (_get_unsigned('s', 0) * 1024ul * 1024ul);
+}
+
+/**
+ *  Get the number of checks after which a worker is replaced.
+ *
+ *  @return Maximum number of checks per worker, 0 if unlimited.
+ */
+unsigned int options::get_worker_max_jobs() const {
+  return (_get_unsigned('j', 1000));
+}
+
+/**
+ *  Get the memory growth after which a worker is replaced.
+ *
+ *  @return Maximum memory growth of a worker in bytes, 0 if
+ *          unlimited.
+ */
+unsigned long options::get_worker_max_memory() const {
+  return (_get_unsigned('m', 0) * 1024ul * 1024ul);
+}
+
+/**
+ *  Get the number of worker processes.
+ *
+ *  @return Number of pre-forked worker processes, 0 if a process
+ *          should be forked for each check.
+ */
+unsigned int options::get_workers() const {
+  return (_get_unsigned('w', 0));
+}
+
+/**
+ *  Check whether checks are forked by a zygote process.
+ *
+ *  @return true if checks are forked by a zygote process.
+ */
+bool options::get_zygote() const {
+  return (get_argument('z').get_is_set());
+}
+
 /**
  *  Get the help.
  */
@@ -82,7 +155,16 @@ std::string options::help() const {
       << "  --debug    " << debug_description << "\n"
       << "  --help     " << help_description << "\n"
       << "  --version  " << version_description << "\n"
-      << "  --code     " << code_description << "\n";
+      << "  --code     " << code_description << "\n"
+      << "  --max-concurrent-checks " << max_concurrent_checks_description
+      << "\n"
+      << "  --script-cache-size " << script_cache_size_description
+      << "\n"
+      << "  --workers  " << workers_description << "\n"
+      << "  --worker-max-jobs " << worker_max_jobs_description << "\n"
+      << "  --worker-max-memory " << worker_max_memory_description
+      << "\n"
+      << "  --zygote   " << zygote_description << "\n";
       // << "\n"
       // << "Commands must be sent on the connector's standard input.\n"
       // << "They must be sent using Centreon Connector protocol version\n"
@@ -119,6 +201,37 @@ std::string options::usage() const {
 *                                     *
 **************************************/
 
+/**
+ *  Get the value of an unsigned integer argument.
+ *
+ *  @param[in] name          Argument short name.
+ *  @param[in] default_value Value returned if argument is not set.
+ *
+ *  @return Argument value.
+ */
+unsigned int options::_get_unsigned(
+                        char name,
+                        unsigned int default_value) const {
+  std::map<char, misc::argument>::const_iterator
+    it(_arguments.find(name));
+  if ((it == _arguments.end()) || !it->second.get_is_set())
+    return (default_value);
+  // strtoul() accepts signs and leading spaces, negative values
+  // would wrap around.
+  char* end(NULL);
+  char const* value(it->second.get_value().c_str());
+  errno = 0;
+  unsigned long retval(strtoul(value, &end, 10));
+  if ((*value < '0')
+      || (*value > '9')
+      || *end
+      || (errno == ERANGE)
+      || (retval > UINT_MAX))
+    throw (basic_error() << "invalid value '" << value
+           << "' for argument '" << it->second.get_long_name() << "'");
+  return (retval);
+}
+
 /**
  *  Init argument table.
  */
@@ -165,5 +278,58 @@ void options::_init() {
     arg.set_has_value(true);
   }
 
+  // Max concurrent checks.
+  {
+    misc::argument& arg(_arguments['C']);
+    arg.set_name('C');
+    arg.set_long_name("max-concurrent-checks");
+    arg.set_description(max_concurrent_checks_description);
+    arg.set_has_value(true);
+  }
+
+  // Script cache size.
+  {
+    misc::argument& arg(_arguments['s']);
+    arg.set_name('s');
+    arg.set_long_name("script-cache-size");
+    arg.set_description(script_cache_size_description);
+    arg.set_has_value(true);
+  }
+
+  // Worker max jobs.
+  {
+    misc::argument& arg(_arguments['j']);
+    arg.set_name('j');
+    arg.set_long_name("worker-max-jobs");
+    arg.set_description(worker_max_jobs_description);
+    arg.set_has_value(true);
+  }
+
+  // Worker max memory.
+  {
+    misc::argument& arg(_arguments['m']);
+    arg.set_name('m');
+    arg.set_long_name("worker-max-memory");
+    arg.set_description(worker_max_memory_description);
+    arg.set_has_value(true);
+  }
+
+  // Workers.
+  {
+    misc::argument& arg(_arguments['w']);
+    arg.set_name('w');
+    arg.set_long_name("workers");
+    arg.set_description(workers_description);
+    arg.set_has_value(true);
+  }
+
+  // Zygote.
+  {
+    misc::argument& arg(_arguments['z']);
+    arg.set_name('z');
+    arg.set_long_name("zygote");
+    arg.set_description(zygote_description);
+  }
+
   return ;
 }
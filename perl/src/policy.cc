@@ -20,13 +20,17 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <ctime>
 #include <memory>
 #include <sys/wait.h>
 #include "com/centreon/concurrency/locker.hh"
 #include "com/centreon/concurrency/mutex.hh"
 #include "com/centreon/connector/perl/checks/check.hh"
 #include "com/centreon/connector/perl/multiplexer.hh"
+#include "com/centreon/connector/perl/options.hh"
 #include "com/centreon/connector/perl/policy.hh"
+#include "com/centreon/connector/perl/worker_pool.hh"
+#include "com/centreon/connector/perl/zygote.hh"
 #include "com/centreon/exceptions/basic.hh"
 #include "com/centreon/logging/logger.hh"
 
@@ -43,9 +47,23 @@ extern volatile bool should_exit;
 **************************************/
 
 /**
- *  Default constructor.
+ *  Constructor.
+ *
+ *  @param[in] opts Program options.
  */
-policy::policy() : _sin(stdin), _sout(stdout) {
+policy::policy(options const& opts)
+  : _max_concurrent_checks(opts.get_max_concurrent_checks()),
+    _sin(stdin),
+    _sout(stdout) {
+  // Fork worker processes.
+  if (opts.get_workers())
+    _pool.reset(new worker_pool(
+                      opts.get_workers(),
+                      opts.get_worker_max_jobs(),
+                      opts.get_worker_max_memory()));
+  else if (opts.get_zygote())
+    _zygote.reset(new zygote);
+
   // Send information back.
   multiplexer::instance().handle_manager::add(&_sout, &_reporter);
 
@@ -80,6 +98,19 @@ policy::~policy() throw () {
     delete it->second;
   }
   _checks.clear();
+  for (std::multimap<time_t, queued_check>::iterator
+         it(_queue.begin()), end(_queue.end());
+       it != end;
+       ++it) {
+    try {
+      it->second.chk->unlisten(this);
+    }
+    catch (...) {}
+    delete it->second.chk;
+  }
+  _queue.clear();
+  _pool.reset();
+  _zygote.reset();
 }
 
 /**
@@ -115,10 +146,30 @@ void policy::on_execute(
                std::string const& cmd) {
   std::auto_ptr<checks::check> chk(new checks::check);
   chk->listen(this);
+  _purge_queue();
   try {
-    pid_t child(chk->execute(cmd_id, cmd, timeout));
-    _checks[child] = chk.get();
-    chk.release();
+    if (_pool.get()) {
+      chk->queue(cmd_id, timeout);
+      _pool->execute(chk.get(), cmd, timeout);
+      chk.release();
+    }
+    else if (_max_concurrent_checks
+             && (_checks.size() + _queue.size()
+                 >= _max_concurrent_checks)) {
+      log_debug(logging::medium) << "check " << cmd_id
+        << " is queued, " << _checks.size() << " checks are running";
+      chk->queue(cmd_id, timeout);
+      queued_check q;
+      q.chk = chk.get();
+      q.cmd = cmd;
+      _queue.insert(std::make_pair(timeout, q));
+      chk.release();
+    }
+    else {
+      pid_t child(chk->execute(cmd_id, cmd, timeout, _zygote.get()));
+      _checks[child] = chk.get();
+      chk.release();
+    }
   }
   catch (std::exception const& e) {
     log_info(logging::low) << "execution of check "
@@ -154,6 +205,7 @@ void policy::on_result(checks::result const& r) {
 
   // Send check result back to monitoring engine.
   _reporter.send_result(r);
+  multiplexer::instance().handle_manager::update(&_sout);
 
   return ;
 }
@@ -166,6 +218,7 @@ void policy::on_version() {
   log_info(logging::medium)
     << "monitoring engine requested protocol version, sending 1.0";
   _reporter.send_version(1, 0);
+  multiplexer::instance().handle_manager::update(&_sout);
   return ;
 }
 
@@ -178,20 +231,18 @@ bool policy::run() {
   // No error occurred yet.
   _error = false;
 
-  while (!should_exit || !_checks.empty()) {
+  while (!should_exit
+         || !_checks.empty()
+         || !_queue.empty()
+         || (_pool.get() && _pool->is_busy())) {
     // Run multiplexer.
     multiplexer::instance().multiplex();
 
-    // Is there some terminated child ?
+    // Is there some terminated child ? Children are reaped as soon as
+    // SIGCHLD is received.
     int status(0);
-    pid_t child(waitpid(0, &status, WNOHANG));
-    while ((child != 0) && (child != (pid_t)-1)) {
-      // Check for error.
-      if ((child == (pid_t)-1) && (errno != ECHILD)) {
-        char const* msg(strerror(errno));
-        throw (basic_error() << "waitpid failed: " << msg);
-      }
-
+    pid_t child(_wait(&status));
+    while (child != 0) {
       // Handle process termination.
       log_info(logging::medium) << "process " << child
         << " exited with status " << status;
@@ -202,12 +253,20 @@ bool policy::run() {
         _checks.erase(it);
         chk->terminated(WIFEXITED(status) ? WEXITSTATUS(status) : -1);
       }
+      else if (_pool.get())
+        _pool->terminated(child, status);
+      else if (_zygote.get() && (child == _zygote->get_pid()))
+        throw (basic_error() << "zygote process exited with status "
+               << status);
       log_debug(logging::medium)
         << _checks.size() << " checks still running";
 
       // Is there any other terminated child ?
-      child = waitpid(0, &status, WNOHANG);
+      child = _wait(&status);
     }
+
+    // Start checks that were waiting for a free slot.
+    _start_queued();
   }
 
   // Run as long as some data remains.
@@ -218,3 +277,81 @@ bool policy::run() {
 
   return (!_error);
 }
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  @brief Remove queued checks that cannot run anymore.
+ *
+ *  Checks whose timeout expired while queued were already answered.
+ *  Checks that do not have enough time left would be killed right
+ *  away, they are answered now. Such checks are at the front of the
+ *  queue, which is sorted by deadline, and must not count toward the
+ *  maximum number of concurrent checks.
+ */
+void policy::_purge_queue() {
+  time_t now(time(NULL));
+  while (!_queue.empty()
+         && (!_queue.begin()->second.chk->get_command_id()
+             || (_queue.begin()->first - 1 <= now))) {
+    std::auto_ptr<checks::check> chk(_queue.begin()->second.chk);
+    _queue.erase(_queue.begin());
+    unsigned long long cmd_id(chk->get_command_id());
+    if (cmd_id) {
+      log_info(logging::low) << "check " << cmd_id
+        << " reached timeout while queued";
+      chk->failed();
+    }
+  }
+  return ;
+}
+
+/**
+ *  @brief Start queued checks as long as the maximum number of running
+ *  checks is not reached.
+ *
+ *  Checks are started by earliest deadline. Checks whose timeout
+ *  expired while queued were already answered and are never forked.
+ */
+void policy::_start_queued() {
+  _purge_queue();
+  while (!_queue.empty()
+         && (!_max_concurrent_checks
+             || (_checks.size() < _max_concurrent_checks))) {
+    std::auto_ptr<checks::check> chk(_queue.begin()->second.chk);
+    std::string cmd(_queue.begin()->second.cmd);
+    _queue.erase(_queue.begin());
+    unsigned long long cmd_id(chk->get_command_id());
+    try {
+      pid_t child(chk->start(cmd, _zygote.get()));
+      _checks[child] = chk.get();
+      chk.release();
+    }
+    catch (std::exception const& e) {
+      log_info(logging::low) << "execution of check "
+        << cmd_id << " failed: " << e.what();
+      chk->failed();
+    }
+    _purge_queue();
+  }
+  return ;
+}
+
+/**
+ *  Get a terminated process, either a child of the connector or a
+ *  check process forked by the zygote.
+ *
+ *  @param[out] status Process status, as returned by waitpid().
+ *
+ *  @return Process ID, 0 if no process terminated.
+ */
+pid_t policy::_wait(int* status) {
+  pid_t child(_reaper.wait(status));
+  if (!child && _zygote.get())
+    child = _zygote->wait(status);
+  return (child);
+}
@@ -0,0 +1,141 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+#include "com/centreon/connector/perl/multiplexer.hh"
+#include "com/centreon/connector/perl/reaper.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::perl;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor. Must be called before any child process is forked.
+ */
+reaper::reaper() {
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGCHLD);
+  if (sigprocmask(SIG_BLOCK, &mask, &_old_mask)) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not block SIGCHLD: " << msg);
+  }
+  int fd(signalfd(-1, &mask, SFD_NONBLOCK));
+  if (fd < 0) {
+    char const* msg(strerror(errno));
+    sigprocmask(SIG_SETMASK, &_old_mask, NULL);
+    throw (basic_error() << "could not create signalfd: " << msg);
+  }
+  _signal.set_fd(fd);
+  multiplexer::instance().handle_manager::add(&_signal, this);
+}
+
+/**
+ *  Destructor.
+ */
+reaper::~reaper() throw () {
+  try {
+    multiplexer::instance().handle_manager::remove(&_signal);
+  }
+  catch (...) {}
+  _signal.close();
+  sigprocmask(SIG_SETMASK, &_old_mask, NULL);
+}
+
+/**
+ *  Error occurred on the signalfd.
+ *
+ *  @param[in] h Unused.
+ */
+void reaper::error(handle& h) {
+  (void)h;
+  throw (basic_error() << "error on SIGCHLD descriptor");
+}
+
+/**
+ *  Reap terminated children.
+ *
+ *  @param[in] h Unused.
+ */
+void reaper::read(handle& h) {
+  (void)h;
+
+  // Signals are merged, one read is enough.
+  signalfd_siginfo info[16];
+  ssize_t rb(::read(_signal.get_native_handle(), info, sizeof(info)));
+  if ((rb < 0) && (errno != EAGAIN) && (errno != EINTR)) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not read SIGCHLD descriptor: " << msg);
+  }
+
+  // Reap all terminated children.
+  int status;
+  pid_t child;
+  while ((child = waitpid(0, &status, WNOHANG)) > 0)
+    _exited.push_back(std::make_pair(child, status));
+  return ;
+}
+
+/**
+ *  Restore the signal mask of a forked process, so that a script gets
+ *  the usual signal behavior.
+ */
+void reaper::unblock() {
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigprocmask(SIG_SETMASK, &mask, NULL);
+  return ;
+}
+
+/**
+ *  Get a child that terminated.
+ *
+ *  @param[out] status Process status, as returned by waitpid().
+ *
+ *  @return Process ID, 0 if no child terminated.
+ */
+pid_t reaper::wait(int* status) {
+  if (_exited.empty())
+    return (0);
+  pid_t child(_exited.front().first);
+  *status = _exited.front().second;
+  _exited.pop_front();
+  return (child);
+}
+
+/**
+ *  Signal descriptor is always read.
+ *
+ *  @param[in] h Unused.
+ *
+ *  @return true.
+ */
+bool reaper::want_read(handle& h) {
+  (void)h;
+  return (true);
+}
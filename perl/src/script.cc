@@ -102,8 +102,29 @@ char const* const com::centreon::connector::perl::embedded_perl::_script =
   "  my $res;\n" \
   "  eval { $res = $handle->(@parsed_args) };\n" \
   "  if ($@) {\n" \
+  "    die($@) if (ref($@) eq 'Embed::Persistent::Exit');\n" \
   "    chomp($@);\n" \
   "    die \"could not run '$filename': $@\";\n" \
   "  }\n" \
   "  return ($res);\n" \
+  "}\n" \
+  "\n" \
+  "sub uncache_file {\n" \
+  "  my ($filename) = @_;\n" \
+  "  delete($Cache{$filename});\n" \
+  "\n" \
+  "  # Release the code of the script.\n" \
+  "  my $package = valid_package_name($filename);\n" \
+  "  no strict 'refs';\n" \
+  "  undef %{$package.'::'};\n" \
+  "}\n" \
+  "\n" \
+  "sub trap_exit {\n" \
+  "  # Scripts compiled from now on return their exit code to\n" \
+  "  # run_file() instead of terminating the process.\n" \
+  "  no warnings 'redefine';\n" \
+  "  *CORE::GLOBAL::exit = sub {\n" \
+  "    die(bless({ code => (defined($_[0]) ? $_[0] : 0) },\n" \
+  "              'Embed::Persistent::Exit'));\n" \
+  "  };\n" \
   "}\n\n";
@@ -0,0 +1,529 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "com/centreon/connector/perl/checks/check.hh"
+#include "com/centreon/connector/perl/embedded_perl.hh"
+#include "com/centreon/connector/perl/multiplexer.hh"
+#include "com/centreon/connector/perl/reaper.hh"
+#include "com/centreon/connector/perl/worker.hh"
+#include "com/centreon/connector/perl/worker_pool.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::perl;
+
+// Temporary output path.
+#define OUTPUT_PATH "/tmp/centreon_connector_perl_output.XXXXXX"
+
+/**************************************
+*                                     *
+*           Local Objects             *
+*                                     *
+**************************************/
+
+/**
+ *  Create an anonymous temporary file.
+ *
+ *  @return File descriptor, -1 on error.
+ */
+static int open_output() {
+  char path[] = OUTPUT_PATH;
+  int fd(mkstemp(path));
+  if (fd >= 0)
+    unlink(path);
+  return (fd);
+}
+
+/**
+ *  Read the whole content of an output file and truncate it.
+ *
+ *  @param[in] fd Output file descriptor.
+ *
+ *  @return File content.
+ */
+static std::string read_output(int fd) {
+  std::string data;
+  if (lseek(fd, 0, SEEK_SET) == 0) {
+    char buffer[4096];
+    ssize_t rb;
+    while (((rb = ::read(fd, buffer, sizeof(buffer))) > 0)
+           || ((rb < 0) && (EINTR == errno)))
+      if (rb > 0)
+        data.append(buffer, rb);
+  }
+  if (ftruncate(fd, 0) || lseek(fd, 0, SEEK_SET)) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not reset script output: " << msg);
+  }
+  return (data);
+}
+
+/**
+ *  Get the resident memory of the current process.
+ *
+ *  @return Resident memory in bytes, 0 if it could not be read.
+ */
+static unsigned long resident_memory() {
+  unsigned long pages(0);
+  unsigned long resident(0);
+  FILE* f(fopen("/proc/self/statm", "r"));
+  if (f) {
+    if (fscanf(f, "%lu %lu", &pages, &resident) != 2)
+      resident = 0;
+    fclose(f);
+  }
+  return (resident * sysconf(_SC_PAGESIZE));
+}
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor. Fork the worker process.
+ *
+ *  @param[in] pool       Pool notified when the worker is idle.
+ *  @param[in] max_jobs   Number of checks after which the worker
+ *                        process exits, 0 if unlimited.
+ *  @param[in] max_memory Memory growth in bytes after which the worker
+ *                        process exits, 0 if unlimited.
+ */
+worker::worker(
+          worker_pool* pool,
+          unsigned int max_jobs,
+          unsigned long max_memory)
+  : _check(NULL),
+    _jobs(0),
+    _pid((pid_t)-1),
+    _pool(pool),
+    _retired(false) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds)) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not create worker socket: " << msg);
+  }
+  pid_t child(fork());
+  if (child < 0) {
+    char const* msg(strerror(errno));
+    ::close(fds[0]);
+    ::close(fds[1]);
+    throw (basic_error() << "could not fork worker process: " << msg);
+  }
+  else if (!child) {
+    ::close(fds[0]);
+    _serve(fds[1], max_jobs, max_memory);
+  }
+  ::close(fds[1]);
+  _pid = child;
+  _socket.set_fd(fds[0]);
+  multiplexer::instance().handle_manager::add(&_socket, this);
+  log_debug(logging::medium) << "worker process " << _pid << " started";
+}
+
+/**
+ *  Destructor.
+ */
+worker::~worker() throw () {
+  _close();
+}
+
+/**
+ *  Error occurred on the worker socket.
+ *
+ *  @param[in] h Unused.
+ */
+void worker::error(handle& h) {
+  (void)h;
+  log_error(logging::low) << "error on socket of worker process "
+    << _pid << ", killing it";
+  kill(_pid, SIGKILL);
+  _close();
+  return ;
+}
+
+/**
+ *  Send a check to the worker process.
+ *
+ *  @param[in] chk Check, owned by the worker pool.
+ *  @param[in] cmd Command line.
+ */
+void worker::execute(checks::check* chk, std::string const& cmd) {
+  log_debug(logging::medium) << "check " << chk->get_command_id()
+    << " is run by worker process " << _pid;
+  _check = chk;
+  _check->started(_pid);
+  _wbuffer.append(cmd);
+  _wbuffer.push_back('\0');
+  multiplexer::instance().handle_manager::update(&_socket);
+  return ;
+}
+
+/**
+ *  Get the check currently run by the worker.
+ *
+ *  @return Current check, NULL if worker is idle.
+ */
+checks::check* worker::get_check() const throw () {
+  return (_check);
+}
+
+/**
+ *  Get the number of checks completed by the worker.
+ *
+ *  @return Number of checks the worker process replied to.
+ */
+unsigned int worker::get_jobs() const throw () {
+  return (_jobs);
+}
+
+/**
+ *  Get the worker process ID.
+ *
+ *  @return Process ID.
+ */
+pid_t worker::get_pid() const throw () {
+  return (_pid);
+}
+
+/**
+ *  Check whether the worker will not accept any more check.
+ *
+ *  @return true if the worker process is exiting.
+ */
+bool worker::is_retired() const throw () {
+  return (_retired);
+}
+
+/**
+ *  Read a check reply from the worker process.
+ *
+ *  @param[in] h Unused.
+ */
+void worker::read(handle& h) {
+  (void)h;
+  char buffer[4096];
+  unsigned long rb;
+  try {
+    rb = _socket.read(buffer, sizeof(buffer));
+  }
+  catch (std::exception const& e) {
+    log_error(logging::low) << "worker process " << _pid
+      << ": " << e.what();
+    rb = 0;
+  }
+  if (!rb) {
+    log_debug(logging::medium) << "worker process " << _pid
+      << " closed its socket";
+    _close();
+    return ;
+  }
+  _rbuffer.append(buffer, rb);
+  _parse_reply();
+  return ;
+}
+
+/**
+ *  Worker process termination callback.
+ *
+ *  @param[in] status Process status, as returned by waitpid().
+ */
+void worker::terminated(int status) {
+  log_info(logging::medium) << "worker process " << _pid
+    << " exited with status " << status;
+
+  // Read possibly remaining reply.
+  _retired = true;
+  try {
+    char buffer[4096];
+    unsigned long rb;
+    while ((_socket.get_native_handle() >= 0)
+           && ((rb = _socket.read(buffer, sizeof(buffer))) != 0))
+      _rbuffer.append(buffer, rb);
+  }
+  catch (...) {}
+  _parse_reply();
+  _close();
+
+  // Check was interrupted.
+  if (_check) {
+    std::auto_ptr<checks::check> chk(_check);
+    _check = NULL;
+    std::ostringstream oss;
+    oss << "worker process " << _pid;
+    if (WIFSIGNALED(status))
+      oss << " was killed by signal " << WTERMSIG(status);
+    else
+      oss << " exited with status " << WEXITSTATUS(status);
+    oss << " while running the check";
+    log_info(logging::low) << "execution of check "
+      << chk->get_command_id() << " failed: " << oss.str();
+    chk->failed(oss.str());
+  }
+  _pid = (pid_t)-1;
+  return ;
+}
+
+/**
+ *  Worker socket is always read, replies might come at any time.
+ *
+ *  @param[in] h Unused.
+ *
+ *  @return true.
+ */
+bool worker::want_read(handle& h) {
+  (void)h;
+  return (true);
+}
+
+/**
+ *  Check whether some command is waiting to be sent.
+ *
+ *  @param[in] h Unused.
+ *
+ *  @return true if a command is waiting to be sent.
+ */
+bool worker::want_write(handle& h) {
+  (void)h;
+  return (!_wbuffer.empty());
+}
+
+/**
+ *  Send pending command to the worker process.
+ *
+ *  @param[in] h Unused.
+ */
+void worker::write(handle& h) {
+  (void)h;
+  try {
+    unsigned long wb(_socket.write(_wbuffer.data(), _wbuffer.size()));
+    _wbuffer.erase(0, wb);
+  }
+  catch (std::exception const& e) {
+    log_error(logging::low) << "worker process " << _pid
+      << ": " << e.what();
+    kill(_pid, SIGKILL);
+    _close();
+  }
+  return ;
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Stop talking to the worker process.
+ */
+void worker::_close() {
+  _retired = true;
+  multiplexer::instance().handle_manager::remove(&_socket);
+  _socket.close();
+  _wbuffer.clear();
+  return ;
+}
+
+/**
+ *  @brief Parse a reply of the worker process.
+ *
+ *  A reply is made of the executed flag, the exit code, the retired
+ *  flag, the output size and the error size, all null-terminated,
+ *  followed by the output and the error.
+ *
+ *  @return true if a complete reply was parsed.
+ */
+bool worker::_parse_reply() {
+  // Parse header.
+  unsigned long header[5];
+  size_t pos(0);
+  for (unsigned int i(0); i < sizeof(header) / sizeof(*header); ++i) {
+    size_t end(_rbuffer.find('\0', pos));
+    if (end == std::string::npos)
+      return (false);
+    header[i] = strtoul(_rbuffer.c_str() + pos, NULL, 10);
+    pos = end + 1;
+  }
+  if (_rbuffer.size() < pos + header[3] + header[4])
+    return (false);
+  std::string output(_rbuffer, pos, header[3]);
+  std::string error(_rbuffer, pos + header[3], header[4]);
+  _rbuffer.erase(0, pos + header[3] + header[4]);
+  ++_jobs;
+  if (header[2]) {
+    log_debug(logging::medium) << "worker process " << _pid
+      << " is retiring";
+    _retired = true;
+  }
+
+  // Send check result.
+  if (_check) {
+    std::auto_ptr<checks::check> chk(_check);
+    _check = NULL;
+    if (header[0])
+      chk->terminated(header[1], output, error);
+    else {
+      log_info(logging::low) << "execution of check "
+        << chk->get_command_id() << " failed: " << error;
+      chk->failed(error);
+    }
+  }
+
+  // Ready for next check.
+  if (!_retired)
+    _pool->on_idle(this);
+  return (true);
+}
+
+/**
+ *  Run checks sent by the connector. Executed by the worker process.
+ *
+ *  @param[in] fd         Worker socket.
+ *  @param[in] max_jobs   Number of checks after which the process
+ *                        exits, 0 if unlimited.
+ *  @param[in] max_memory Memory growth in bytes after which the
+ *                        process exits, 0 if unlimited.
+ */
+void worker::_serve(
+               int fd,
+               unsigned int max_jobs,
+               unsigned long max_memory) {
+  // Close existing file descriptors.
+  try {
+    pipe_handle::close_all_handles();
+  }
+  catch (std::exception const& e) {
+    std::cerr << "could not close all inherited FDs: "
+              << e.what() << std::endl;
+    _exit(3);
+  }
+
+  // Timeouts terminate the worker.
+  signal(SIGTERM, SIG_DFL);
+  reaper::unblock();
+
+  // Detach from connector's standard streams, stderr is kept for logs.
+  int null_fd(open("/dev/null", O_RDWR));
+  if ((null_fd < 0)
+      || (dup2(null_fd, STDIN_FILENO) < 0)
+      || (dup2(null_fd, STDOUT_FILENO) < 0)) {
+    char const* msg(strerror(errno));
+    std::cerr << "could not open /dev/null: " << msg << std::endl;
+    _exit(3);
+  }
+  if (null_fd > STDERR_FILENO)
+    ::close(null_fd);
+
+  // Script outputs.
+  int err_fd(open_output());
+  int out_fd(open_output());
+  if ((err_fd < 0) || (out_fd < 0)) {
+    char const* msg(strerror(errno));
+    std::cerr << "could not create temporary file: " << msg
+              << std::endl;
+    _exit(3);
+  }
+
+  // Scripts must return from exit().
+  embedded_perl::instance().trap_exit();
+
+  unsigned long base_memory(resident_memory());
+  std::string buffer;
+  unsigned int jobs(0);
+  bool retired(false);
+  while (!retired) {
+    // Wait for next command.
+    size_t pos;
+    while ((pos = buffer.find('\0')) == std::string::npos) {
+      char chunk[4096];
+      ssize_t rb(::read(fd, chunk, sizeof(chunk)));
+      if ((rb < 0) && (EINTR == errno))
+        continue ;
+      // Connector is gone.
+      if (rb <= 0)
+        _exit(EXIT_SUCCESS);
+      buffer.append(chunk, rb);
+    }
+    std::string cmd(buffer, 0, pos);
+    buffer.erase(0, pos + 1);
+
+    // Run check.
+    bool executed(true);
+    int exit_code(0);
+    std::string error;
+    std::string output;
+    try {
+      exit_code = embedded_perl::instance().execute(cmd, out_fd, err_fd);
+      error = read_output(err_fd);
+      output = read_output(out_fd);
+    }
+    catch (std::exception const& e) {
+      executed = false;
+      error = e.what();
+    }
+
+    // Retire when limits are reached.
+    ++jobs;
+    retired = ((max_jobs && (jobs >= max_jobs))
+               || (max_memory
+                   && (resident_memory() > base_memory + max_memory)));
+
+    // Send reply.
+    std::ostringstream oss;
+    oss << (executed ? 1 : 0);
+    oss.put('\0');
+    oss << exit_code;
+    oss.put('\0');
+    oss << (retired ? 1 : 0);
+    oss.put('\0');
+    oss << output.size();
+    oss.put('\0');
+    oss << error.size();
+    oss.put('\0');
+    oss << output << error;
+    std::string reply(oss.str());
+    char const* data(reply.data());
+    size_t len(reply.size());
+    while (len > 0) {
+      ssize_t wb(::write(fd, data, len));
+      if (wb <= 0) {
+        if ((wb < 0) && (EINTR == errno))
+          continue ;
+        _exit(EXIT_FAILURE);
+      }
+      len -= wb;
+      data += wb;
+    }
+  }
+  _exit(EXIT_SUCCESS);
+}
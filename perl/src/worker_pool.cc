@@ -0,0 +1,273 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdlib>
+#include <memory>
+#include <sys/wait.h>
+#include "com/centreon/connector/perl/checks/check.hh"
+#include "com/centreon/connector/perl/multiplexer.hh"
+#include "com/centreon/connector/perl/worker.hh"
+#include "com/centreon/connector/perl/worker_pool.hh"
+#include "com/centreon/logging/logger.hh"
+#include "com/centreon/timestamp.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::perl;
+
+// Exit flag.
+extern volatile bool should_exit;
+
+// Delays in milliseconds before replacing workers that keep dying
+// before completing any check.
+static unsigned int const respawn_delay_min(100);
+static unsigned int const respawn_delay_max(10000);
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor. Fork all worker processes.
+ *
+ *  @param[in] size       Number of worker processes.
+ *  @param[in] max_jobs   Number of checks after which a worker process
+ *                        is replaced, 0 if unlimited.
+ *  @param[in] max_memory Memory growth in bytes after which a worker
+ *                        process is replaced, 0 if unlimited.
+ */
+worker_pool::worker_pool(
+               unsigned int size,
+               unsigned int max_jobs,
+               unsigned long max_memory)
+  : _early_deaths(0),
+    _max_jobs(max_jobs),
+    _max_memory(max_memory),
+    _respawn(0),
+    _size(size) {
+  log_info(logging::low) << "starting " << _size
+    << " worker processes";
+  for (unsigned int i(0); i < _size; ++i)
+    _spawn();
+}
+
+/**
+ *  Destructor. Checks that are still waiting or running are answered
+ *  as not executed.
+ */
+worker_pool::~worker_pool() throw () {
+  if (_respawn) {
+    try {
+      multiplexer::instance().com::centreon::task_manager::remove(
+        _respawn);
+    }
+    catch (...) {}
+  }
+  for (std::multimap<time_t, std::pair<checks::check*, std::string> >::iterator
+         it(_pending.begin()), end(_pending.end());
+       it != end;
+       ++it)
+    delete it->second.first;
+  _pending.clear();
+  for (std::map<pid_t, worker*>::iterator
+         it(_workers.begin()), end(_workers.end());
+       it != end;
+       ++it) {
+    delete it->second->get_check();
+    delete it->second;
+  }
+  _idle.clear();
+  _workers.clear();
+}
+
+/**
+ *  Run a check on the first idle worker. When all workers are busy,
+ *  the check with the earliest deadline is served first.
+ *
+ *  @param[in] chk      Queued check, the pool takes its ownership.
+ *  @param[in] cmd      Command line.
+ *  @param[in] deadline Check timeout.
+ */
+void worker_pool::execute(
+                    checks::check* chk,
+                    std::string const& cmd,
+                    time_t deadline) {
+  _pending.insert(std::make_pair(deadline, std::make_pair(chk, cmd)));
+  _dispatch();
+  return ;
+}
+
+/**
+ *  Check whether some checks are still waiting or running.
+ *
+ *  @return true if the pool has some work left.
+ */
+bool worker_pool::is_busy() const {
+  for (std::map<pid_t, worker*>::const_iterator
+         it(_workers.begin()), end(_workers.end());
+       it != end;
+       ++it)
+    if (it->second->get_check())
+      return (true);
+  for (std::multimap<time_t, std::pair<checks::check*, std::string> >::const_iterator
+         it(_pending.begin()), end(_pending.end());
+       it != end;
+       ++it)
+    if (it->second.first->get_command_id())
+      return (true);
+  return (false);
+}
+
+/**
+ *  A worker finished its check and can run another one.
+ *
+ *  @param[in] w Idle worker.
+ */
+void worker_pool::on_idle(worker* w) {
+  _idle.push_back(w);
+  _dispatch();
+  return ;
+}
+
+/**
+ *  Replace the workers that died, once their replacement delay
+ *  expired.
+ */
+void worker_pool::run() {
+  _respawn = 0;
+  _replace();
+  _dispatch();
+  return ;
+}
+
+/**
+ *  Process termination callback.
+ *
+ *  @param[in] pid    Process ID.
+ *  @param[in] status Process status, as returned by waitpid().
+ *
+ *  @return true if process was a worker of this pool.
+ */
+bool worker_pool::terminated(pid_t pid, int status) {
+  std::map<pid_t, worker*>::iterator it(_workers.find(pid));
+  if (it == _workers.end())
+    return (false);
+  std::auto_ptr<worker> w(it->second);
+  _workers.erase(it);
+  _idle.remove(w.get());
+  bool early(!w->get_jobs()
+             && (!WIFEXITED(status)
+                 || (WEXITSTATUS(status) != EXIT_SUCCESS)));
+  w->terminated(status);
+  w.reset();
+
+  // A worker that keeps dying before completing any check might not be
+  // able to start at all, do not turn it into a fork loop.
+  if (!early)
+    _early_deaths = 0;
+  else if (++_early_deaths > 1) {
+    if (!_respawn) {
+      unsigned int delay(respawn_delay_min);
+      for (unsigned int i(2);
+           (i < _early_deaths) && (delay < respawn_delay_max);
+           ++i)
+        delay *= 2;
+      if (delay > respawn_delay_max)
+        delay = respawn_delay_max;
+      log_error(logging::low) << _early_deaths << " worker processes "
+        "in a row died before completing any check, replacing them in "
+        << delay << " ms";
+      timestamp when(timestamp::now());
+      when.add_mseconds(delay);
+      _respawn = multiplexer::instance().com::centreon::task_manager::add(
+                   this,
+                   when,
+                   false,
+                   false);
+    }
+    _dispatch();
+    return (true);
+  }
+
+  // Replace worker.
+  if (!_respawn)
+    _replace();
+  _dispatch();
+  return (true);
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Give waiting checks to idle workers.
+ */
+void worker_pool::_dispatch() {
+  while (!_pending.empty()) {
+    // Check already timed out while waiting.
+    checks::check* chk(_pending.begin()->second.first);
+    if (!chk->get_command_id()) {
+      delete chk;
+      _pending.erase(_pending.begin());
+      continue ;
+    }
+
+    // Find an idle worker.
+    while (!_idle.empty() && _idle.front()->is_retired())
+      _idle.pop_front();
+    if (_idle.empty())
+      break ;
+    worker* w(_idle.front());
+    _idle.pop_front();
+    w->execute(chk, _pending.begin()->second.second);
+    _pending.erase(_pending.begin());
+  }
+  return ;
+}
+
+/**
+ *  Fork workers until the pool is full again, unless connector is
+ *  exiting and no check waits.
+ */
+void worker_pool::_replace() {
+  if (should_exit && _pending.empty())
+    return ;
+  try {
+    while (_workers.size() < _size)
+      _spawn();
+  }
+  catch (std::exception const& e) {
+    log_error(logging::low)
+      << "could not replace worker process: " << e.what();
+  }
+  return ;
+}
+
+/**
+ *  Fork a new worker process.
+ */
+void worker_pool::_spawn() {
+  std::auto_ptr<worker> w(new worker(this, _max_jobs, _max_memory));
+  _workers[w->get_pid()] = w.get();
+  _idle.push_back(w.release());
+  return ;
+}
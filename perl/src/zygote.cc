@@ -0,0 +1,443 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sstream>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "com/centreon/connector/perl/embedded_perl.hh"
+#include "com/centreon/connector/perl/multiplexer.hh"
+#include "com/centreon/connector/perl/zygote.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::perl;
+
+// Maximum size of a command sent to the zygote.
+#define MAX_COMMAND_SIZE 65536
+
+/**************************************
+*                                     *
+*           Local Objects             *
+*                                     *
+**************************************/
+
+/**
+ *  Send a reply to the connector, with the pipes of the check process
+ *  if it could be forked. Executed by the zygote process.
+ *
+ *  @param[in] fd   Request socket.
+ *  @param[in] data Reply data.
+ *  @param[in] fds  Pipes of the check process, NULL on error.
+ */
+static void send_reply(int fd, std::string const& data, int const* fds) {
+  iovec iov;
+  iov.iov_base = const_cast<char*>(data.data());
+  iov.iov_len = data.size();
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  char control[CMSG_SPACE(3 * sizeof(int))];
+  if (fds) {
+    memset(control, 0, sizeof(control));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr* cmsg(CMSG_FIRSTHDR(&msg));
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(3 * sizeof(int));
+    memcpy(CMSG_DATA(cmsg), fds, 3 * sizeof(int));
+  }
+  while (sendmsg(fd, &msg, 0) < 0)
+    if (errno != EINTR)
+      _exit(EXIT_FAILURE);
+  return ;
+}
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor. Fork the zygote process.
+ */
+zygote::zygote() : _pid((pid_t)-1) {
+  int requests[2];
+  if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, requests)) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not create zygote socket: " << msg);
+  }
+  int statuses[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, statuses)) {
+    char const* msg(strerror(errno));
+    ::close(requests[0]);
+    ::close(requests[1]);
+    throw (basic_error() << "could not create zygote socket: " << msg);
+  }
+  pid_t child(fork());
+  if (child < 0) {
+    char const* msg(strerror(errno));
+    ::close(requests[0]);
+    ::close(requests[1]);
+    ::close(statuses[0]);
+    ::close(statuses[1]);
+    throw (basic_error() << "could not fork zygote process: " << msg);
+  }
+  else if (!child) {
+    ::close(requests[0]);
+    ::close(statuses[0]);
+    _serve(requests[1], statuses[1]);
+  }
+  ::close(requests[1]);
+  ::close(statuses[1]);
+  _pid = child;
+  _requests.set_fd(requests[0]);
+  _statuses.set_fd(statuses[0]);
+  multiplexer::instance().handle_manager::add(&_statuses, this);
+  log_info(logging::medium) << "zygote process " << _pid << " started";
+}
+
+/**
+ *  Destructor. The zygote process exits when its sockets are closed.
+ */
+zygote::~zygote() throw () {
+  try {
+    multiplexer::instance().handle_manager::remove(&_statuses);
+  }
+  catch (...) {}
+}
+
+/**
+ *  Error occurred on the status socket.
+ *
+ *  @param[in] h Unused.
+ */
+void zygote::error(handle& h) {
+  (void)h;
+  log_error(logging::low) << "error on status socket of zygote process "
+    << _pid;
+  multiplexer::instance().handle_manager::remove(&_statuses);
+  return ;
+}
+
+/**
+ *  Get the zygote process ID.
+ *
+ *  @return Process ID.
+ */
+pid_t zygote::get_pid() const throw () {
+  return (_pid);
+}
+
+/**
+ *  Read exit statuses of check processes.
+ *
+ *  @param[in] h Unused.
+ */
+void zygote::read(handle& h) {
+  (void)h;
+  char buffer[4096];
+  unsigned long rb(_statuses.read(buffer, sizeof(buffer)));
+  if (!rb) {
+    log_error(logging::low) << "zygote process " << _pid
+      << " closed its status socket";
+    multiplexer::instance().handle_manager::remove(&_statuses);
+    return ;
+  }
+  _buffer.append(buffer, rb);
+
+  // Each status is made of the process ID and its status.
+  size_t pid_end;
+  size_t status_end;
+  while (((pid_end = _buffer.find('\0')) != std::string::npos)
+         && ((status_end = _buffer.find('\0', pid_end + 1))
+             != std::string::npos)) {
+    pid_t child(strtol(_buffer.c_str(), NULL, 10));
+    int status(strtol(_buffer.c_str() + pid_end + 1, NULL, 10));
+    _buffer.erase(0, status_end + 1);
+    _exited.push_back(std::make_pair(child, status));
+  }
+  return ;
+}
+
+/**
+ *  Make the zygote fork a check process.
+ *
+ *  @param[in]  cmd Command to execute.
+ *  @param[out] fds Process' file descriptors.
+ *
+ *  @return Process ID.
+ */
+pid_t zygote::run(std::string const& cmd, int fds[3]) {
+  // Check arguments.
+  if (!fds)
+    throw (basic_error() << "cannot run Perl script without " \
+             "fetching process' descriptors");
+  if (cmd.size() > MAX_COMMAND_SIZE)
+    throw (basic_error() << "command is too long");
+
+  // Send request.
+  int fd(_requests.get_native_handle());
+  ssize_t wb;
+  do {
+    wb = send(fd, cmd.data(), cmd.size(), MSG_NOSIGNAL);
+  } while ((wb < 0) && (EINTR == errno));
+  if (wb < 0) {
+    char const* msg(strerror(errno));
+    throw (basic_error()
+           << "could not send command to zygote process: " << msg);
+  }
+
+  // Wait for reply.
+  char data[4096];
+  iovec iov;
+  iov.iov_base = data;
+  iov.iov_len = sizeof(data) - 1;
+  char control[CMSG_SPACE(3 * sizeof(int))];
+  msghdr hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.msg_iov = &iov;
+  hdr.msg_iovlen = 1;
+  hdr.msg_control = control;
+  hdr.msg_controllen = sizeof(control);
+  ssize_t rb;
+  do {
+    rb = recvmsg(fd, &hdr, 0);
+  } while ((rb < 0) && (EINTR == errno));
+  if (rb <= 0) {
+    char const* msg(rb ? strerror(errno) : "connection closed");
+    throw (basic_error()
+           << "could not read reply of zygote process: " << msg);
+  }
+  data[rb] = '\0';
+
+  // Fetch pipes.
+  unsigned int received(0);
+  for (cmsghdr* cmsg(CMSG_FIRSTHDR(&hdr));
+       cmsg;
+       cmsg = CMSG_NXTHDR(&hdr, cmsg))
+    if ((SOL_SOCKET == cmsg->cmsg_level)
+        && (SCM_RIGHTS == cmsg->cmsg_type)) {
+      int const* passed(reinterpret_cast<int const*>(CMSG_DATA(cmsg)));
+      unsigned int count((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+      for (unsigned int i(0); i < count; ++i) {
+        if (received < 3)
+          fds[received++] = passed[i];
+        else
+          ::close(passed[i]);
+      }
+    }
+
+  // Reply is the process ID, or 0 and an error message.
+  pid_t child(strtol(data, NULL, 10));
+  if ((child <= 0) || (received != 3)) {
+    for (unsigned int i(0); i < received; ++i)
+      ::close(fds[i]);
+    size_t len(strlen(data));
+    throw (basic_error() << ((len + 1 < static_cast<size_t>(rb))
+                             ? data + len + 1
+                             : "invalid reply of zygote process"));
+  }
+  log_debug(logging::medium) << "zygote process forked process "
+    << child;
+  return (child);
+}
+
+/**
+ *  Get a check process that terminated.
+ *
+ *  @param[out] status Process status, as returned by waitpid().
+ *
+ *  @return Process ID, 0 if no process terminated.
+ */
+pid_t zygote::wait(int* status) {
+  if (_exited.empty())
+    return (0);
+  pid_t child(_exited.front().first);
+  *status = _exited.front().second;
+  _exited.pop_front();
+  return (child);
+}
+
+/**
+ *  Status socket is always read.
+ *
+ *  @param[in] h Unused.
+ *
+ *  @return true.
+ */
+bool zygote::want_read(handle& h) {
+  (void)h;
+  return (true);
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Fork check processes on request of the connector and report their
+ *  exit status. Executed by the zygote process.
+ *
+ *  @param[in] requests Request socket.
+ *  @param[in] statuses Status socket.
+ */
+void zygote::_serve(int requests, int statuses) {
+  // Close existing file descriptors.
+  try {
+    pipe_handle::close_all_handles();
+  }
+  catch (std::exception const& e) {
+    std::cerr << "could not close all inherited FDs: "
+              << e.what() << std::endl;
+    _exit(3);
+  }
+  signal(SIGTERM, SIG_DFL);
+
+  // Detach from connector's standard streams, stderr is kept for logs.
+  int null_fd(open("/dev/null", O_RDWR));
+  if ((null_fd < 0)
+      || (dup2(null_fd, STDIN_FILENO) < 0)
+      || (dup2(null_fd, STDOUT_FILENO) < 0)) {
+    char const* msg(strerror(errno));
+    std::cerr << "could not open /dev/null: " << msg << std::endl;
+    _exit(3);
+  }
+  if (null_fd > STDERR_FILENO)
+    ::close(null_fd);
+
+  // Terminations are read from a signalfd. SIGCHLD is only unblocked
+  // while forking, check processes inherit the default signal mask.
+  sigset_t blocked;
+  sigset_t unblocked;
+  sigemptyset(&blocked);
+  sigaddset(&blocked, SIGCHLD);
+  sigemptyset(&unblocked);
+  sigprocmask(SIG_SETMASK, &blocked, NULL);
+  int signal_fd(signalfd(-1, &blocked, SFD_NONBLOCK));
+  if ((signal_fd < 0) || (fcntl(statuses, F_SETFL, O_NONBLOCK) < 0)) {
+    char const* msg(strerror(errno));
+    std::cerr << "could not setup zygote process: " << msg
+              << std::endl;
+    _exit(3);
+  }
+
+  // Check processes close these descriptors.
+  pipe_handle requests_handle(requests);
+  pipe_handle signal_handle(signal_fd);
+  pipe_handle statuses_handle(statuses);
+
+  std::vector<char> buffer(MAX_COMMAND_SIZE);
+  std::string pending;
+  while (true) {
+    // Reap check processes.
+    int status;
+    pid_t child;
+    while ((child = waitpid(-1, &status, WNOHANG)) > 0) {
+      std::ostringstream oss;
+      oss << child;
+      oss.put('\0');
+      oss << status;
+      oss.put('\0');
+      pending.append(oss.str());
+    }
+
+    // Report exit statuses.
+    while (!pending.empty()) {
+      ssize_t wb(::write(statuses, pending.data(), pending.size()));
+      if (wb > 0)
+        pending.erase(0, wb);
+      else if ((wb < 0) && (EAGAIN == errno))
+        break ;
+      else if ((wb < 0) && (EINTR == errno))
+        continue ;
+      else
+        _exit(EXIT_FAILURE);
+    }
+
+    // Wait for requests or terminations.
+    pollfd fds[3];
+    memset(fds, 0, sizeof(fds));
+    fds[0].fd = requests;
+    fds[0].events = POLLIN;
+    fds[1].fd = signal_fd;
+    fds[1].events = POLLIN;
+    fds[2].fd = statuses;
+    fds[2].events = (pending.empty() ? 0 : POLLOUT);
+    if (poll(fds, sizeof(fds) / sizeof(*fds), -1) < 0) {
+      if (EINTR == errno)
+        continue ;
+      _exit(EXIT_FAILURE);
+    }
+    if (fds[1].revents & POLLIN) {
+      signalfd_siginfo info;
+      while (::read(signal_fd, &info, sizeof(info)) > 0)
+        ;
+    }
+    if (fds[2].revents & (POLLERR | POLLHUP))
+      _exit(EXIT_SUCCESS);
+    if (!fds[0].revents)
+      continue ;
+
+    // Read request, connector is gone if socket is closed.
+    ssize_t rb(recv(requests, &buffer[0], buffer.size(), 0));
+    if ((rb < 0) && (EINTR == errno))
+      continue ;
+    if (rb <= 0)
+      _exit(EXIT_SUCCESS);
+    std::string cmd(&buffer[0], rb);
+
+    // Fork check process.
+    std::ostringstream reply;
+    int pipes[3];
+    child = 0;
+    sigprocmask(SIG_SETMASK, &unblocked, NULL);
+    try {
+      child = embedded_perl::instance().run(cmd, pipes);
+      reply << child;
+      reply.put('\0');
+    }
+    catch (std::exception const& e) {
+      reply << 0;
+      reply.put('\0');
+      reply << e.what();
+    }
+    sigprocmask(SIG_BLOCK, &blocked, NULL);
+
+    // Hand pipes back to the connector.
+    send_reply(requests, reply.str(), ((child > 0) ? pipes : NULL));
+    if (child > 0)
+      for (unsigned int i(0); i < 3; ++i)
+        ::close(pipes[i]);
+  }
+}
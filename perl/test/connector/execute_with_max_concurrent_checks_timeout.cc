@@ -0,0 +1,174 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include "com/centreon/clib.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/io/file_stream.hh"
+#include "com/centreon/process.hh"
+#include "test/connector/misc.hh"
+#include "test/connector/paths.hh"
+
+using namespace com::centreon;
+
+#define CMD1 "2\0"
+#define CMD2 "\0" \
+             "123456789\0"
+#define CMD3 "\0\0\0\0"
+#define RESULT "Merethis is wonderful\n"
+
+#define SCRIPT_SLOW "#!/usr/bin/perl\n" \
+                    "\n" \
+                    "sleep(3);\n" \
+                    "print \"Merethis is wonderful\\n\";\n" \
+                    "exit 2;\n"
+
+/**
+ *  Write an execution request.
+ *
+ *  @param[out] oss     Request stream.
+ *  @param[in]  cmd_id  Command ID.
+ *  @param[in]  timeout Check timeout.
+ *  @param[in]  script  Script path.
+ */
+static void write_request(
+              std::ostringstream& oss,
+              unsigned int cmd_id,
+              unsigned int timeout,
+              std::string const& script) {
+  oss.write(CMD1, sizeof(CMD1) - 1);
+  oss << cmd_id;
+  oss.put('\0');
+  oss << timeout;
+  oss.write(CMD2, sizeof(CMD2) - 1);
+  oss << script;
+  oss.write(CMD3, sizeof(CMD3) - 1);
+  return ;
+}
+
+/**
+ *  Check that a check waiting for a free slot behind slow checks is
+ *  answered as not executed when its timeout expires, and is never
+ *  run.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  clib::load();
+  // Write Perl scripts. The last one leaves a marker if it is run.
+  std::string slow_path(io::file_stream::temp_path());
+  write_file(slow_path.c_str(), SCRIPT_SLOW, sizeof(SCRIPT_SLOW) - 1);
+  std::string marker_path(io::file_stream::temp_path());
+  std::string marker_script;
+  {
+    std::ostringstream oss;
+    oss << "#!/usr/bin/perl\n"
+        << "\n"
+        << "open(my $fh, '>', '" << marker_path << "');\n"
+        << "close($fh);\n"
+        << "exit 0;\n";
+    marker_script = oss.str();
+  }
+  std::string marker_script_path(io::file_stream::temp_path());
+  write_file(marker_script_path.c_str(), marker_script.c_str());
+
+  // Process.
+  process p;
+  p.enable_stream(process::in, true);
+  p.enable_stream(process::out, true);
+  p.exec(CONNECTOR_PERL_BINARY " --max-concurrent-checks 2");
+
+  // Two slow checks use all slots, the third one must wait for them
+  // longer than its timeout.
+  std::string cmd;
+  {
+    std::ostringstream oss;
+    write_request(oss, 1, 10, slow_path);
+    write_request(oss, 2, 10, slow_path);
+    write_request(oss, 3, 1, marker_script_path);
+    cmd = oss.str();
+  }
+  char const* ptr(cmd.c_str());
+  unsigned int size(cmd.size());
+  while (size > 0) {
+    unsigned int rb(p.write(ptr, size));
+    size -= rb;
+    ptr += rb;
+  }
+  p.enable_stream(process::in, false);
+
+  // Read reply.
+  std::string output;
+  while (true) {
+    std::string buffer;
+    p.read(buffer);
+    if (buffer.empty())
+      break;
+    output.append(buffer);
+  }
+
+  // Wait for process termination.
+  int retval(1);
+  if (!p.wait(10000)) {
+    p.terminate();
+    p.wait();
+  }
+  else
+    retval = (p.exit_code() != 0);
+
+  // Was the queued check run ?
+  bool marker_exists(!access(marker_path.c_str(), F_OK));
+
+  // Remove temporary files.
+  remove(slow_path.c_str());
+  remove(marker_path.c_str());
+  remove(marker_script_path.c_str());
+
+  unsigned int nb_right_output(0);
+  for (size_t pos(0);
+       (pos = output.find(RESULT, pos)) != std::string::npos;
+       ++nb_right_output, ++pos)
+    ;
+
+  try {
+    if (nb_right_output != 2)
+      throw (basic_error()
+             << "invalid output of slow checks: size=" << output.size()
+             << ", output=" << replace_null(output));
+    std::string replies(std::string("\0\0\0\0", 4) + output);
+    if (replies.find(std::string("\0\0\0\0" "3\0" "3\0" "0\0", 10))
+        == std::string::npos)
+      throw (basic_error()
+             << "queued check was not answered as not executed: output="
+             << replace_null(output));
+    if (marker_exists)
+      throw (basic_error() << "queued check was run after its timeout");
+  }
+  catch (std::exception const& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+    retval = 1;
+  }
+
+  clib::unload();
+  // Return check result.
+  return (retval);
+}
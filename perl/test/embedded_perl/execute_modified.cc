@@ -0,0 +1,141 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include "com/centreon/connector/perl/embedded_perl.hh"
+#include "com/centreon/connector/perl/pipe_handle.hh"
+#include "com/centreon/io/file_stream.hh"
+#include "com/centreon/logging/engine.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::perl;
+
+/**
+ *  Read a file from its beginning.
+ *
+ *  @param[in] fd File descriptor.
+ *
+ *  @return File content.
+ */
+static std::string read_all(int fd) {
+  std::string data;
+  lseek(fd, 0, SEEK_SET);
+  char buffer[1024];
+  ssize_t rb;
+  while ((rb = read(fd, buffer, sizeof(buffer))) > 0)
+    data.append(buffer, rb);
+  return (data);
+}
+
+/**
+ *  Write a Perl script.
+ *
+ *  @param[in] path Script path.
+ *  @param[in] data Script content.
+ */
+static void write_script(std::string const& path, char const* data) {
+  io::file_stream fs;
+  fs.open(path.c_str(), "w");
+  unsigned int size(strlen(data));
+  unsigned int rb(1);
+  do {
+    rb = fs.write(data, size);
+    size -= rb;
+    data += rb;
+  } while ((rb > 0) && (size > 0));
+  fs.close();
+  return ;
+}
+
+/**
+ *  Check that a script modified after it was compiled is compiled
+ *  again.
+ *
+ *  @param[in] argc Argument count.
+ *  @param[in] argv Argument values.
+ *  @param[in] env  Process environment.
+ *
+ *  @return 0 on success.
+ */
+int main(int argc, char* argv[], char* env[]) {
+  // Initialization.
+  logging::engine::load();
+  pipe_handle::load();
+  embedded_perl::load(&argc, &argv, &env);
+  embedded_perl::instance().trap_exit();
+
+  // Return value.
+  int retval(EXIT_FAILURE);
+
+  // Temporary files.
+  std::string script_path(io::file_stream::temp_path());
+  std::string out_path(io::file_stream::temp_path());
+  std::string err_path(io::file_stream::temp_path());
+  try {
+    io::file_stream out;
+    out.open(out_path.c_str(), "w+");
+    io::file_stream err;
+    err.open(err_path.c_str(), "w+");
+
+    // Execute script, modify it within the same second and execute it
+    // again.
+    write_script(script_path, "print \"first\\n\";\nexit 1;\n");
+    int first(embedded_perl::instance().execute(
+                                          script_path,
+                                          out.get_native_handle(),
+                                          err.get_native_handle()));
+    write_script(script_path, "print \"second\\n\";\nexit 2;\n");
+    int second(embedded_perl::instance().execute(
+                                           script_path,
+                                           out.get_native_handle(),
+                                           err.get_native_handle()));
+    std::string output(read_all(out.get_native_handle()));
+    std::string error(read_all(err.get_native_handle()));
+    retval = ((first != 1)
+              || (second != 2)
+              || (output != "first\nsecond\n")
+              || !error.empty());
+    if (retval)
+      std::cerr << "modified script was not compiled again: first="
+                << first << ", second=" << second << ", output="
+                << output << ", error=" << error << std::endl;
+  }
+  catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
+  }
+  catch (...) {
+    std::cerr << "unknown error" << std::endl;
+  }
+
+  // Remove temporary files.
+  remove(script_path.c_str());
+  remove(out_path.c_str());
+  remove(err_path.c_str());
+
+  // Unload.
+  embedded_perl::unload();
+  pipe_handle::unload();
+  logging::engine::unload();
+
+  return (retval);
+}
@@ -22,10 +22,12 @@
 #  include <list>
 #  include <string>
 #  include <ctime>
+#  include <vector>
 #  include "com/centreon/connector/ssh/checks/listener.hh"
 #  include "com/centreon/connector/ssh/namespace.hh"
 #  include "com/centreon/connector/ssh/sessions/listener.hh"
 #  include "com/centreon/connector/ssh/sessions/session.hh"
+#  include "com/centreon/connector/ssh/sessions/shell_listener.hh"
 
 CCCS_BEGIN()
 
@@ -37,9 +39,13 @@ namespace                  checks {
    *  @class check check.hh "com/centreon/connector/ssh/checks/check.hh"
    *  @brief Execute a check on a host.
    *
-   *  Execute a check by opening a new channel on a SSH session.
+   *  Execute a check by opening a new channel on a SSH session, or
+   *  by the persistent shell of the session if it has one. Multiple
+   *  commands can be run in parallel by child checks.
    */
-  class                    check : public sessions::listener {
+  class                    check : public checks::listener,
+                                   public sessions::listener,
+                                   public sessions::shell_listener {
   public:
                            check(
                              int skip_stdout = -1,
@@ -54,7 +60,14 @@ namespace                  checks {
     void                   on_available(sessions::session& sess);
     void                   on_close(sessions::session& sess);
     void                   on_connected(sessions::session& sess);
+    void                   on_result(result const& r);
+    void                   on_shell_error(std::string const& msg);
+    void                   on_shell_result(
+                             std::string const& out,
+                             std::string const& err,
+                             int exit_code);
     void                   on_timeout();
+    void                   set_parallel(bool parallel) throw ();
     void                   unlisten(checks::listener* listnr);
 
   private:
@@ -62,22 +75,33 @@ namespace                  checks {
       chan_open = 1,
       chan_exec,
       chan_read,
-      chan_close
+      chan_close,
+      shell_exec,
+      shell_wait
     };
 
                            check(check const& c);
     check&                 operator=(check const& c);
     bool                   _close();
     bool                   _exec();
+    void                   _execute_parallel(
+                             sessions::session& sess,
+                             time_t tmt);
     bool                   _open();
     bool                   _read();
+    void                   _send_output(int exit_code);
     void                   _send_result_and_unregister(result const& r);
     static std::string&    _skip_data(std::string& data, int nb_line);
 
     LIBSSH2_CHANNEL*       _channel;
+    std::vector<check*>    _children;
     std::list<std::string> _cmds;
     unsigned long long     _cmd_id;
+    time_t                 _deadline;
     checks::listener*      _listnr;
+    bool                   _parallel;
+    unsigned int           _pending;
+    std::vector<result>    _results;
     sessions::session*     _session;
     int                    _skip_stderr;
     int                    _skip_stdout;
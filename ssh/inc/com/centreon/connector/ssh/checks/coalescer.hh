@@ -0,0 +1,88 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_CHECKS_COALESCER_HH
+#  define CCCS_CHECKS_COALESCER_HH
+
+#  include <ctime>
+#  include <list>
+#  include <map>
+#  include <string>
+#  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/connector/ssh/sessions/credentials.hh"
+
+CCCS_BEGIN()
+
+namespace        checks {
+  /**
+   *  @class coalescer coalescer.hh "com/centreon/connector/ssh/checks/coalescer.hh"
+   *  @brief Group identical checks.
+   *
+   *  A check attaches to a running identical check that will time out
+   *  no later than itself and gets a copy of its result. If that check
+   *  could not be executed, attached checks that still have time left
+   *  must run on their own.
+   */
+  class          coalescer {
+  public:
+    struct       key {
+      bool       operator<(key const& k) const;
+
+      std::list<std::string>
+                 cmds;
+      sessions::credentials
+                 creds;
+      int        skip_stderr;
+      int        skip_stdout;
+      bool       use_ipv6;
+    };
+
+                 coalescer();
+                 ~coalescer() throw ();
+    bool         attach(
+                   unsigned long long cmd_id,
+                   key const& k,
+                   time_t deadline);
+    bool         detach(
+                   unsigned long long cmd_id,
+                   bool executed,
+                   time_t now,
+                   key& k,
+                   std::list<unsigned long long>& copies,
+                   std::multimap<time_t, unsigned long long>& retries);
+
+  private:
+    struct       group {
+      time_t     deadline;
+      std::multimap<time_t, unsigned long long>
+                 followers;
+    };
+
+                 coalescer(coalescer const& c);
+    coalescer&   operator=(coalescer const& c);
+
+    std::map<key, group>
+                 _groups;
+    std::map<unsigned long long, key>
+                 _leaders;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_CHECKS_COALESCER_HH
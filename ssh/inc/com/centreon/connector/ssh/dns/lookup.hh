@@ -0,0 +1,78 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_DNS_LOOKUP_HH
+#  define CCCS_DNS_LOOKUP_HH
+
+#  include <string>
+#  include <sys/socket.h>
+#  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/task.hh"
+
+CCCS_BEGIN()
+
+// Forward declaration.
+class                multiplexer;
+
+namespace            dns {
+  // Forward declaration.
+  class              listener;
+
+  /**
+   *  @class lookup lookup.hh "com/centreon/connector/ssh/dns/lookup.hh"
+   *  @brief Pending name resolution.
+   *
+   *  A lookup is performed by a resolver thread then posted to the
+   *  multiplexer of the thread that requested it, where its listener
+   *  is notified.
+   */
+  class              lookup : public com::centreon::task {
+  public:
+                     lookup(
+                       std::string const& host,
+                       int family,
+                       listener* listnr,
+                       multiplexer* target);
+                     ~lookup() throw ();
+    int              get_family() const throw ();
+    std::string const&
+                     get_host() const throw ();
+    multiplexer*     get_target() const throw ();
+    void             run();
+    void             set_error(std::string const& msg);
+    void             set_listener(listener* listnr) throw ();
+    void             set_result(sockaddr const* addr, socklen_t addrlen);
+    void             set_target(multiplexer* target) throw ();
+
+  private:
+                     lookup(lookup const& l);
+    lookup&          operator=(lookup const& l);
+
+    sockaddr_storage _addr;
+    socklen_t        _addrlen;
+    std::string      _error;
+    int              _family;
+    std::string      _host;
+    listener*        _listnr;
+    multiplexer*     _target;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_DNS_LOOKUP_HH
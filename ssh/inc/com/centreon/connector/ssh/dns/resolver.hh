@@ -0,0 +1,121 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_DNS_RESOLVER_HH
+#  define CCCS_DNS_RESOLVER_HH
+
+#  include <list>
+#  include <map>
+#  include <string>
+#  include <sys/socket.h>
+#  include <utility>
+#  include <vector>
+#  include "com/centreon/concurrency/condvar.hh"
+#  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/concurrency/thread.hh"
+#  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/timestamp.hh"
+
+CCCS_BEGIN()
+
+namespace              dns {
+  // Forward declarations.
+  class                listener;
+  class                lookup;
+
+  /**
+   *  @class resolver resolver.hh "com/centreon/connector/ssh/dns/resolver.hh"
+   *  @brief Asynchronous and cached name resolution.
+   *
+   *  Singleton that resolves host names with a pool of threads so
+   *  that multiplexing threads never block on getaddrinfo(). Results
+   *  (successful or not) are cached for a limited time, per host and
+   *  address family.
+   */
+  class                resolver {
+  public:
+                       ~resolver() throw ();
+    void               cancel(lookup* l);
+    bool               find(
+                         std::string const& host,
+                         int family,
+                         sockaddr_storage& addr,
+                         socklen_t& addrlen);
+    static resolver&   instance() throw ();
+    static void        load(
+                         unsigned int ttl = 60,
+                         unsigned int negative_ttl = 10,
+                         unsigned int threads = 4);
+    lookup*            resolve(
+                         std::string const& host,
+                         int family,
+                         listener* listnr);
+    static void        unload();
+
+  private:
+    struct             entry {
+      sockaddr_storage addr;
+      socklen_t        addrlen;
+      std::string      error;
+      timestamp        expiry;
+    };
+
+    class              resolver_thread
+      : public com::centreon::concurrency::thread {
+    public:
+                       resolver_thread(resolver* r);
+                       ~resolver_thread() throw ();
+
+    protected:
+      void             _run();
+
+    private:
+      resolver*        _resolver;
+    };
+
+                       resolver(
+                         unsigned int ttl,
+                         unsigned int negative_ttl,
+                         unsigned int threads);
+                       resolver(resolver const& r);
+    resolver&          operator=(resolver const& r);
+    void               _process();
+    void               _purge(timestamp const& now);
+    static void        _resolve(
+                         std::string const& host,
+                         int family,
+                         entry& e);
+
+    std::map<std::pair<std::string, int>, entry>
+                       _cache;
+    concurrency::condvar
+                       _cv;
+    concurrency::mutex _mutex;
+    unsigned int       _negative_ttl;
+    timestamp          _next_purge;
+    std::list<lookup*> _pending;
+    bool               _quit;
+    std::vector<resolver_thread*>
+                       _threads;
+    unsigned int       _ttl;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_DNS_RESOLVER_HH
@@ -19,9 +19,10 @@
 #ifndef CCCS_MULTIPLEXER_HH
 #  define CCCS_MULTIPLEXER_HH
 
-#  include "com/centreon/handle_manager.hh"
 #  include "com/centreon/task_manager.hh"
+#  include "com/centreon/connector/handle_manager.hh"
 #  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/connector/ssh/wakeup.hh"
 
 CCCS_BEGIN()
 
@@ -30,21 +31,26 @@ CCCS_BEGIN()
  *  @brief Multiplexing class.
  *
  *  Singleton that aggregates multiplexing features such as file
- *  descriptor monitoring and task execution.
+ *  descriptor monitoring and task execution. There is one instance
+ *  per thread running a reactor loop (see worker). Other threads
+ *  can hand tasks over to a multiplexer with post().
  */
 class                 multiplexer
   : public com::centreon::task_manager,
-    public com::centreon::handle_manager {
+    public com::centreon::connector::handle_manager {
 public:
                       ~multiplexer() throw ();
   static multiplexer& instance() throw ();
   static void         load();
+  void                post(com::centreon::task* t);
   static void         unload();
 
 private:
                       multiplexer();
                       multiplexer(multiplexer const& m);
   multiplexer&        operator=(multiplexer const& m);
+
+  wakeup              _wakeup;
 };
 
 CCCS_END()
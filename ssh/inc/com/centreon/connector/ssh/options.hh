@@ -36,11 +36,43 @@ public:
               options(options const& opts);
               ~options() throw ();
   options&    operator=(options const& opts);
+  unsigned int
+              get_backoff_max() const;
+  unsigned int
+              get_backoff_min() const;
+  bool        get_coalesce_checks() const;
+  unsigned int
+              get_connect_rate() const;
+  unsigned int
+              get_connect_timeout() const;
+  unsigned int
+              get_dns_negative_ttl() const;
+  unsigned int
+              get_dns_ttl() const;
+  unsigned int
+              get_idle_timeout() const;
+  unsigned int
+              get_keepalive_count() const;
+  unsigned int
+              get_keepalive_interval() const;
+  unsigned int
+              get_max_channels() const;
+  unsigned int
+              get_max_handshakes() const;
+  unsigned int
+              get_max_sessions() const;
+  bool        get_parallel_commands() const;
+  bool        get_persistent_shell() const;
+  std::string get_state_file() const;
+  unsigned int
+              get_workers() const;
   std::string help() const;
   void        parse(int argc, char* argv[]);
   std::string usage() const;
 
 private:
+  unsigned int
+              _get_unsigned(char name, unsigned int default_value) const;
   void        _init();
 };
 
@@ -21,6 +21,7 @@
 
 #  include <ctime>
 #  include <list>
+#  include <map>
 #  include <string>
 #  include "com/centreon/connector/ssh/namespace.hh"
 
@@ -55,7 +56,9 @@ namespace        orders {
                    std::list<std::string> const& cmds,
                    int skip_stdout,
                    int skip_stderr,
-                   bool is_ipv6) = 0;
+                   bool is_ipv6,
+                   std::map<std::string, std::string> const& ssh_options)
+                   = 0;
     virtual void on_quit() = 0;
     virtual void on_version() = 0;
   };
@@ -20,6 +20,7 @@
 #  define CCCS_ORDERS_OPTIONS_HH
 
 #  include <list>
+#  include <map>
 #  include <string>
 #  include "com/centreon/connector/ssh/namespace.hh"
 
@@ -49,6 +50,8 @@ namespace                         orders {
     std::string const&            get_identity_file() const throw ();
     ip_protocol                   get_ip_protocol() const throw ();
     unsigned short                get_port() const throw ();
+    std::map<std::string, std::string> const&
+                                  get_ssh_options() const throw ();
     unsigned int                  get_timeout() const throw ();
     std::string const&            get_user() const throw ();
     static std::string            help();
@@ -57,6 +60,7 @@ namespace                         orders {
     int                           skip_stdout() const throw ();
 
   private:
+    void                          _add_ssh_option(std::string const& opt);
     void                          _copy(options const& p);
     static std::string            _get_user_name();
 
@@ -68,6 +72,8 @@ namespace                         orders {
     unsigned short                _port;
     int                           _skip_stderr;
     int                           _skip_stdout;
+    std::map<std::string, std::string>
+                                  _ssh_options;
     unsigned int                  _timeout;
     std::string                   _user;
   };
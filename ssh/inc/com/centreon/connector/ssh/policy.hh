@@ -1,5 +1,5 @@
 /*
-** Copyright 2011-2013 Centreon
+** Copyright 2011-2013,2019 Centreon
 **
 ** Licensed under the Apache License, Version 2.0 (the "License");
 ** you may not use this file except in compliance with the License.
@@ -19,37 +19,43 @@
 #ifndef CCCS_POLICY_HH
 #  define CCCS_POLICY_HH
 
+#  include <ctime>
+#  include <list>
 #  include <map>
-#  include <utility>
+#  include <string>
+#  include <vector>
 #  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/connector/ssh/checks/coalescer.hh"
 #  include "com/centreon/connector/ssh/checks/listener.hh"
+#  include "com/centreon/connector/ssh/checks/result.hh"
 #  include "com/centreon/connector/ssh/orders/listener.hh"
 #  include "com/centreon/connector/ssh/orders/parser.hh"
 #  include "com/centreon/connector/ssh/reporter.hh"
 #  include "com/centreon/connector/ssh/sessions/credentials.hh"
+#  include "com/centreon/connector/ssh/sessions/state_file.hh"
+#  include "com/centreon/connector/ssh/wakeup.hh"
 #  include "com/centreon/io/file_stream.hh"
 
 CCCS_BEGIN()
 
 // Forward declarations.
-namespace         checks {
-  class           check;
-  class           result;
-}
-namespace         sessions {
-  class           session;
-}
+class             options;
+class             worker;
 
 /**
  *  @class policy policy.hh "com/centreon/connector/ssh/policy.hh"
  *  @brief Software policy.
  *
- *  Manage program execution.
+ *  Manage program execution. Orders are read and results are reported
+ *  by the main thread. Checks are executed by workers, each of them
+ *  owning the sessions of a subset of the credentials. Identical checks
+ *  can share the result of a single execution. Sessions active on exit
+ *  can be saved and connected in advance on next start.
  */
 class             policy : public orders::listener,
                            public checks::listener {
 public:
-                  policy();
+                  policy(options const& opts);
                   ~policy() throw ();
   void            on_eof();
   void            on_error(
@@ -66,7 +72,8 @@ public:
                     std::list<std::string> const& cmds,
                     int skip_output,
                     int skip_error,
-                    bool is_ipv6);
+                    bool is_ipv6,
+                    std::map<std::string, std::string> const& ssh_options);
   void            on_quit();
   void            on_result(checks::result const& r);
   void            on_version();
@@ -75,18 +82,33 @@ public:
 private:
                   policy(policy const& p);
   policy&         operator=(policy const& p);
+  void            _dispatch(
+                    unsigned long long cmd_id,
+                    time_t timeout,
+                    checks::coalescer::key const& k);
+  void            _report_results();
+  void            _send_result(checks::result const& r);
+  worker&         _worker_of(sessions::credentials const& creds);
 
-  std::map<unsigned long long, std::pair<checks::check*, sessions::session*> >
-                  _checks;
+  bool            _coalesce;
+  checks::coalescer
+                  _coalescer;
   bool            _error;
+  unsigned int    _in_flight;
   concurrency::mutex
                   _mutex;
   orders::parser  _parser;
   reporter        _reporter;
-  std::map<sessions::credentials, sessions::session*>
-                  _sessions;
+  std::list<checks::result>
+                  _results;
   io::file_stream _sin;
   io::file_stream _sout;
+  sessions::state_file
+                  _state;
+  bool            _threaded;
+  wakeup          _wakeup;
+  std::vector<worker*>
+                  _workers;
 };
 
 CCCS_END()
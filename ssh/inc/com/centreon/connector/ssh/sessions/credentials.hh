@@ -19,6 +19,7 @@
 #ifndef CCCS_SESSIONS_CREDENTIALS_HH
 #  define CCCS_SESSIONS_CREDENTIALS_HH
 
+#  include <map>
 #  include <string>
 #  include "com/centreon/connector/ssh/namespace.hh"
 
@@ -30,7 +31,8 @@ namespace              sessions {
    *  @brief Connection credentials.
    *
    *  Bundle together connection credentials : host, user and
-   *  password. Methods are provided so that they can be compared.
+   *  password, along with SSH transport options. Methods are provided
+   *  so that they can be compared.
    */
   class                credentials {
   public:
@@ -51,11 +53,15 @@ namespace              sessions {
     std::string const& get_host() const;
     std::string const& get_password() const;
     unsigned short     get_port() const;
+    std::map<std::string, std::string> const&
+                       get_ssh_options() const;
     std::string const& get_user() const;
     void               set_host(std::string const& host);
     void               set_key(std::string const& file);
     void               set_password(std::string const& password);
     void               set_port(unsigned short port);
+    void               set_ssh_options(
+                         std::map<std::string, std::string> const& opts);
     void               set_user(std::string const& user);
 
   private:
@@ -65,6 +71,8 @@ namespace              sessions {
     std::string        _key;
     std::string        _password;
     unsigned short     _port;
+    std::map<std::string, std::string>
+                       _ssh_options;
     std::string        _user;
   };
 }
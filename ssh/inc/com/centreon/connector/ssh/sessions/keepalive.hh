@@ -0,0 +1,57 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_SESSIONS_KEEPALIVE_HH
+#  define CCCS_SESSIONS_KEEPALIVE_HH
+
+#  include <cstddef>
+#  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/task.hh"
+
+CCCS_BEGIN()
+
+namespace      sessions {
+  // Forward declaration.
+  class        session;
+
+  /**
+   *  @class keepalive keepalive.hh "com/centreon/connector/ssh/sessions/keepalive.hh"
+   *  @brief Session keepalive.
+   *
+   *  Task executed when a session should send a keepalive message.
+   */
+  class        keepalive : public com::centreon::task {
+  public:
+               keepalive(session* sess = NULL);
+               keepalive(keepalive const& k);
+               ~keepalive() throw ();
+    keepalive& operator=(keepalive const& k);
+    session*   get_session() const throw ();
+    void       run();
+    void       set_session(session* sess) throw ();
+
+  private:
+    void       _internal_copy(keepalive const& k);
+
+    session*   _session;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_SESSIONS_KEEPALIVE_HH
@@ -0,0 +1,67 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_SESSIONS_KEY_CACHE_HH
+#  define CCCS_SESSIONS_KEY_CACHE_HH
+
+#  include <ctime>
+#  include <map>
+#  include <string>
+#  include <sys/types.h>
+#  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/connector/ssh/namespace.hh"
+
+CCCS_BEGIN()
+
+namespace              sessions {
+  /**
+   *  @class key_cache key_cache.hh "com/centreon/connector/ssh/sessions/key_cache.hh"
+   *  @brief Identity files cache.
+   *
+   *  Singleton that keeps the content of key files in memory so that
+   *  they are not read again from disk on every authentication. A
+   *  file is read again when its modification time or size changes.
+   */
+  class                key_cache {
+  public:
+                       ~key_cache() throw ();
+    void               get(std::string const& path, std::string& data);
+    static key_cache&  instance() throw ();
+    static void        load();
+    static void        unload();
+
+  private:
+    struct             entry {
+      std::string      data;
+      time_t           mtime;
+      off_t            size;
+    };
+
+                       key_cache();
+                       key_cache(key_cache const& kc);
+    key_cache&         operator=(key_cache const& kc);
+
+    std::map<std::string, entry>
+                       _entries;
+    concurrency::mutex _mutex;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_SESSIONS_KEY_CACHE_HH
@@ -0,0 +1,75 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_SESSIONS_KNOWN_HOSTS_HH
+#  define CCCS_SESSIONS_KNOWN_HOSTS_HH
+
+#  include <ctime>
+#  include <libssh2.h>
+#  include <map>
+#  include <string>
+#  include <sys/types.h>
+#  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/connector/ssh/namespace.hh"
+
+CCCS_BEGIN()
+
+namespace              sessions {
+  /**
+   *  @class known_hosts known_hosts.hh "com/centreon/connector/ssh/sessions/known_hosts.hh"
+   *  @brief Shared known_hosts file.
+   *
+   *  Singleton that parses the known_hosts file once and checks host
+   *  keys against it. The file is parsed again only when it changes.
+   *  Check results are remembered per host and key until then.
+   */
+  class                known_hosts {
+  public:
+                       ~known_hosts() throw ();
+    int                check(
+                         std::string const& file,
+                         std::string const& host,
+                         char const* key,
+                         size_t len);
+    static known_hosts&
+                       instance() throw ();
+    static void        load();
+    static void        unload();
+
+  private:
+                       known_hosts();
+                       known_hosts(known_hosts const& kh);
+    known_hosts&       operator=(known_hosts const& kh);
+    void               _clear() throw ();
+    void               _reload(std::string const& file);
+
+    std::string        _file;
+    LIBSSH2_KNOWNHOSTS*
+                       _hosts;
+    time_t             _mtime;
+    concurrency::mutex _mutex;
+    std::map<std::string, int>
+                       _results;
+    LIBSSH2_SESSION*   _session;
+    off_t              _size;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_SESSIONS_KNOWN_HOSTS_HH
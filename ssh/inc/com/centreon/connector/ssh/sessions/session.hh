@@ -20,7 +20,15 @@
 #  define CCCS_SESSIONS_SESSION_HH
 
 #  include <libssh2.h>
+#  include <list>
+#  include <map>
 #  include <set>
+#  include <string>
+#  include <sys/socket.h>
+#  include <utility>
+#  include <ctime>
+#  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/connector/ssh/dns/listener.hh"
 #  include "com/centreon/connector/ssh/namespace.hh"
 #  include "com/centreon/connector/ssh/sessions/credentials.hh"
 #  include "com/centreon/connector/ssh/sessions/listener.hh"
@@ -29,37 +37,87 @@
 
 CCCS_BEGIN()
 
+namespace                 dns {
+  // Forward declaration.
+  class                   lookup;
+}
+
 namespace                 sessions {
+  // Forward declarations.
+  class                   shell;
+  class                   tunnel;
+
   /**
    *  @class session session.hh "com/centreon/connector/ssh/session.hh"
    *  @brief SSH session.
    *
    *  SSH session between Centreon SSH Connector and a remote
-   *  host. The session is kept open as long as needed.
+   *  host. The session is kept open as long as needed. The number
+   *  of channels opened simultaneously is limited, listeners that
+   *  cannot get a channel wait in a queue ordered by deadline.
+   *  Connection and authentication must complete within the connect
+   *  timeout.
+   *  Commands can also be run by a persistent shell of the session.
+   *  Channels are closed asynchronously as the socket gets ready.
+   *  Connected sessions send keepalive messages to detect dead peers.
+   *  A session can reach its host through a tunnel opened on a bastion
+   *  session.
    */
-  class                   session : public com::centreon::handle_listener {
+  class                   session : public com::centreon::handle_listener,
+                                    public dns::listener {
   public:
                           session(credentials const& creds);
                           ~session() throw ();
+    bool                  acquire_channel(
+                            sessions::listener* listnr,
+                            time_t deadline = 0);
     void                  close();
+    void                  close_channel(LIBSSH2_CHANNEL* chan);
     void                  connect(bool use_ipv6 = false);
     void                  error();
     void                  error(handle& h);
+    session*              get_bastion() const throw ();
     credentials const&    get_credentials() const throw ();
     LIBSSH2_SESSION*      get_libssh2_session() const throw ();
+    shell*                get_shell();
     socket_handle*        get_socket_handle() throw ();
     bool                  is_connected() const throw ();
-    void                  listen(listener* listnr);
+    bool                  is_connecting() throw ();
+    bool                  is_dead() const throw ();
+    void                  listen(sessions::listener* listnr);
     LIBSSH2_CHANNEL*      new_channel();
+    LIBSSH2_CHANNEL*      new_direct_channel(
+                            std::string const& host,
+                            unsigned short port);
+    void                  on_keepalive();
+    void                  on_resolve_error(std::string const& msg);
+    void                  on_resolved(
+                            sockaddr const* addr,
+                            socklen_t addrlen);
+    void                  on_timeout();
     void                  read(handle& h);
-    void                  unlisten(listener* listnr);
+    void                  release_channel(sessions::listener* listnr);
+    void                  set_bastion(session* bastion) throw ();
+    void                  set_connect_timeout(unsigned int secs);
+    void                  set_keepalive(
+                            unsigned int interval,
+                            unsigned int count);
+    void                  set_max_channels(unsigned int max);
+    void                  set_persistent_shell(bool enable);
+    void                  unlisten(sessions::listener* listnr);
     bool                  want_read(handle& h);
     bool                  want_write(handle& h);
     void                  write(handle& h);
 
   private:
+    struct                closing_channel {
+      LIBSSH2_CHANNEL*    channel;
+      bool                closed;
+      time_t              deadline;
+    };
     enum                  e_step {
       session_startup = 0,
+      session_auth_list,
       session_password,
       session_key,
       session_keepalive,
@@ -68,20 +126,53 @@ namespace                 sessions {
 
                           session(session const& s);
     session&              operator=(session const& s);
+    void                  _auth_list();
     void                  _available();
+    void                  _connect(sockaddr* addr, socklen_t addrlen);
+    void                  _connected();
+    void                  _connect_tunnel();
     void                  _key();
     void                  _passwd();
+    void                  _reap_channels();
+    void                  _remove_task(unsigned long& id);
+    void                  _schedule_keepalive(unsigned int delay);
+    void                  _set_auth_method(e_step method);
+    void                  _set_preferences();
     void                  _startup();
 
+    static std::map<credentials, e_step>
+                          _auth_methods;
+    static concurrency::mutex
+                          _auth_methods_mutex;
+
+    session*              _bastion;
+    std::set<sessions::listener*>
+                          _channels;
+    std::list<closing_channel>
+                          _closing;
+    unsigned int          _connect_timeout;
     credentials           _creds;
-    std::set<listener*>   _listnrs;
-    std::set<listener*>::iterator
+    unsigned long         _keepalive;
+    unsigned int          _keepalive_count;
+    unsigned int          _keepalive_interval;
+    time_t                _last_read;
+    std::set<sessions::listener*>
+                          _listnrs;
+    std::set<sessions::listener*>::iterator
                           _listnrs_it;
+    dns::lookup*          _lookup;
+    unsigned int          _max_channels;
     bool                  _needed_new_chan;
     LIBSSH2_SESSION*      _session;
+    shell*                _shell;
+    bool                  _shell_enabled;
     socket_handle         _socket;
     e_step                _step;
     char const*           _step_string;
+    unsigned long         _timeout;
+    tunnel*               _tunnel;
+    std::list<std::pair<time_t, sessions::listener*> >
+                          _waiting;
   };
 }
 
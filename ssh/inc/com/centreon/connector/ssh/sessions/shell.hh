@@ -0,0 +1,104 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_SESSIONS_SHELL_HH
+#  define CCCS_SESSIONS_SHELL_HH
+
+#  include <libssh2.h>
+#  include <list>
+#  include <string>
+#  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/connector/ssh/sessions/listener.hh"
+
+CCCS_BEGIN()
+
+namespace               sessions {
+  // Forward declarations.
+  class                 session;
+  class                 shell_listener;
+
+  /**
+   *  @class shell shell.hh "com/centreon/connector/ssh/sessions/shell.hh"
+   *  @brief Persistent remote shell.
+   *
+   *  Run commands one after another in a long-lived remote shell
+   *  instead of opening a new channel for each of them. Each command
+   *  is followed by delimiters that bring its exit code back on the
+   *  output stream and mark the end of its error stream.
+   */
+  class                 shell : public sessions::listener {
+  public:
+                        shell(session& sess);
+                        ~shell() throw ();
+    void                cancel(shell_listener* listnr);
+    void                execute(
+                          shell_listener* listnr,
+                          std::string const& cmd);
+    void                on_available(session& sess);
+    void                on_close(session& sess);
+    void                on_connected(session& sess);
+    static bool         parse(
+                          std::string const& token,
+                          std::string& out_buffer,
+                          std::string& err_buffer,
+                          std::string& out,
+                          std::string& err,
+                          int& exit_code);
+    static std::string  wrap(
+                          std::string const& cmd,
+                          std::string const& token);
+
+  private:
+    enum                e_step {
+      shell_open = 1,
+      shell_start,
+      shell_ready
+    };
+    struct              command {
+      std::string       cmd;
+      shell_listener*   listnr;
+    };
+
+                        shell(shell const& s);
+    shell&              operator=(shell const& s);
+    void                _close_channel();
+    void                _fail(std::string const& msg);
+    bool                _open();
+    void                _process();
+    bool                _read();
+    bool                _start();
+    void                _write();
+
+    LIBSSH2_CHANNEL*    _channel;
+    std::list<command>  _commands;
+    bool                _processing;
+    bool                _running;
+    unsigned int        _sequence;
+    session&            _session;
+    std::string         _stderr;
+    std::string         _stdout;
+    e_step              _step;
+    std::string         _token;
+    std::string         _token_prefix;
+    std::string         _wbuf;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_SESSIONS_SHELL_HH
@@ -0,0 +1,52 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_SESSIONS_SHELL_LISTENER_HH
+#  define CCCS_SESSIONS_SHELL_LISTENER_HH
+
+#  include <string>
+#  include "com/centreon/connector/ssh/namespace.hh"
+
+CCCS_BEGIN()
+
+namespace        sessions {
+  /**
+   *  @class shell_listener shell_listener.hh "com/centreon/connector/ssh/sessions/shell_listener.hh"
+   *  @brief Shell listener.
+   *
+   *  Receive the outcome of a command executed by a persistent
+   *  remote shell.
+   */
+  class          shell_listener {
+  public:
+                 shell_listener();
+                 shell_listener(shell_listener const& l);
+    virtual      ~shell_listener();
+    shell_listener&
+                 operator=(shell_listener const& l);
+    virtual void on_shell_error(std::string const& msg) = 0;
+    virtual void on_shell_result(
+                   std::string const& out,
+                   std::string const& err,
+                   int exit_code) = 0;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_SESSIONS_SHELL_LISTENER_HH
@@ -0,0 +1,63 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_SESSIONS_STATE_FILE_HH
+#  define CCCS_SESSIONS_STATE_FILE_HH
+
+#  include <list>
+#  include <set>
+#  include <string>
+#  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/connector/ssh/sessions/credentials.hh"
+
+CCCS_BEGIN()
+
+namespace              sessions {
+  /**
+   *  @class state_file state_file.hh "com/centreon/connector/ssh/sessions/state_file.hh"
+   *  @brief Sessions saved across restarts.
+   *
+   *  Store the credentials of active sessions when the connector
+   *  exits so that they can be connected in advance on next start.
+   *  Passwords are never written, so only credentials that do not
+   *  use one are recorded.
+   */
+  class                state_file {
+  public:
+                       state_file(std::string const& path = "");
+                       ~state_file() throw ();
+    void               add(credentials const& creds);
+    std::string const& get_path() const throw ();
+    void               read(std::list<credentials>& creds) const;
+    void               write();
+
+  private:
+                       state_file(state_file const& sf);
+    state_file&        operator=(state_file const& sf);
+
+    std::set<credentials>
+                       _creds;
+    concurrency::mutex _mutex;
+    std::string        _path;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_SESSIONS_STATE_FILE_HH
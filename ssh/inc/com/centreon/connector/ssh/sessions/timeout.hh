@@ -0,0 +1,57 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_SESSIONS_TIMEOUT_HH
+#  define CCCS_SESSIONS_TIMEOUT_HH
+
+#  include <cstddef>
+#  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/task.hh"
+
+CCCS_BEGIN()
+
+namespace    sessions {
+  // Forward declaration.
+  class      session;
+
+  /**
+   *  @class timeout timeout.hh "com/centreon/connector/ssh/sessions/timeout.hh"
+   *  @brief Session connection timeout.
+   *
+   *  Task executed when a session could not connect in time.
+   */
+  class      timeout : public com::centreon::task {
+  public:
+             timeout(session* sess = NULL);
+             timeout(timeout const& t);
+             ~timeout() throw ();
+    timeout& operator=(timeout const& t);
+    session* get_session() const throw ();
+    void     run();
+    void     set_session(session* sess) throw ();
+
+  private:
+    void     _internal_copy(timeout const& t);
+
+    session* _session;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_SESSIONS_TIMEOUT_HH
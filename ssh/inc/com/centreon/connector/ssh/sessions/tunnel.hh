@@ -0,0 +1,85 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_SESSIONS_TUNNEL_HH
+#  define CCCS_SESSIONS_TUNNEL_HH
+
+#  include <libssh2.h>
+#  include <string>
+#  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/connector/ssh/sessions/listener.hh"
+#  include "com/centreon/connector/ssh/sessions/socket_handle.hh"
+#  include "com/centreon/handle_listener.hh"
+
+CCCS_BEGIN()
+
+namespace                sessions {
+  // Forward declaration.
+  class                  session;
+
+  /**
+   *  @class tunnel tunnel.hh "com/centreon/connector/ssh/sessions/tunnel.hh"
+   *  @brief TCP tunnel through a bastion session.
+   *
+   *  Relay the traffic of a local socket, whose peer is used by the
+   *  session of a remote host, over a direct-tcpip channel of a
+   *  bastion session. Many tunnels can share the same bastion session.
+   *  The local socket is closed when the channel is closed and
+   *  vice versa.
+   */
+  class                  tunnel : public com::centreon::handle_listener,
+                                  public sessions::listener {
+  public:
+                         tunnel(
+                           session& bastion,
+                           std::string const& host,
+                           unsigned short port,
+                           native_handle handl);
+                         ~tunnel() throw ();
+    void                 error(handle& h);
+    void                 on_available(session& sess);
+    void                 on_close(session& sess);
+    void                 on_connected(session& sess);
+    void                 read(handle& h);
+    bool                 want_read(handle& h);
+    bool                 want_write(handle& h);
+    void                 write(handle& h);
+
+  private:
+                         tunnel(tunnel const& t);
+    tunnel&              operator=(tunnel const& t);
+    void                 _close();
+    void                 _flush();
+    void                 _open();
+    void                 _pump();
+    void                 _update();
+
+    session*             _bastion;
+    LIBSSH2_CHANNEL*     _channel;
+    bool                 _eof;
+    std::string          _host;
+    std::string          _in;
+    std::string          _out;
+    unsigned short       _port;
+    socket_handle        _socket;
+  };
+}
+
+CCCS_END()
+
+#endif // !CCCS_SESSIONS_TUNNEL_HH
@@ -0,0 +1,60 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_WAKEUP_HH
+#  define CCCS_WAKEUP_HH
+
+#  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/handle.hh"
+#  include "com/centreon/handle_listener.hh"
+
+CCCS_BEGIN()
+
+/**
+ *  @class wakeup wakeup.hh "com/centreon/connector/ssh/wakeup.hh"
+ *  @brief Interrupt a multiplexer from another thread.
+ *
+ *  Self-pipe registered within a multiplexer. Any thread can call
+ *  wake() to make the multiplexing thread return from its wait and
+ *  process pending work.
+ */
+class           wakeup : public com::centreon::handle,
+                         public com::centreon::handle_listener {
+public:
+                wakeup();
+                ~wakeup() throw ();
+  void          close();
+  void          error(handle& h);
+  native_handle get_native_handle();
+  unsigned long read(void* data, unsigned long size);
+  void          read(handle& h);
+  void          wake();
+  bool          want_read(handle& h);
+  bool          want_write(handle& h);
+  unsigned long write(void const* data, unsigned long size);
+
+private:
+                wakeup(wakeup const& w);
+  wakeup&       operator=(wakeup const& w);
+
+  native_handle _fds[2];
+};
+
+CCCS_END()
+
+#endif // !CCCS_WAKEUP_HH
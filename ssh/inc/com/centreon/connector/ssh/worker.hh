@@ -0,0 +1,180 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#ifndef CCCS_WORKER_HH
+#  define CCCS_WORKER_HH
+
+#  include <ctime>
+#  include <list>
+#  include <map>
+#  include <set>
+#  include <string>
+#  include <utility>
+#  include "com/centreon/concurrency/mutex.hh"
+#  include "com/centreon/concurrency/thread.hh"
+#  include "com/centreon/connector/ssh/checks/listener.hh"
+#  include "com/centreon/connector/ssh/namespace.hh"
+#  include "com/centreon/connector/ssh/sessions/credentials.hh"
+#  include "com/centreon/connector/ssh/wakeup.hh"
+#  include "com/centreon/task.hh"
+#  include "com/centreon/timestamp.hh"
+
+CCCS_BEGIN()
+
+// Forward declarations.
+namespace            checks {
+  class              check;
+  class              result;
+}
+namespace            sessions {
+  class              session;
+  class              state_file;
+}
+class                options;
+
+/**
+ *  @class worker worker.hh "com/centreon/connector/ssh/worker.hh"
+ *  @brief Execute checks on a set of SSH sessions.
+ *
+ *  A worker owns SSH sessions and the checks running on them. It is
+ *  either driven by the main thread's multiplexer or, once started,
+ *  by its own thread and multiplexer. In the latter case, execution
+ *  orders are queued and check results are sent to the listener from
+ *  the worker thread.
+ *
+ *  Idle sessions are periodically reaped when an idle timeout or a
+ *  maximum number of sessions is configured. Checks of hosts that
+ *  recently could not be connected fail immediately for a delay that
+ *  grows exponentially with consecutive failures. New sessions can be
+ *  queued to limit the rate and number of simultaneous handshakes,
+ *  sessions needed by the most urgent checks are connected first.
+ *  Sessions can also be connected in advance, after the sessions
+ *  needed by checks. Sessions using a jump host share a bastion
+ *  session.
+ */
+class                worker : public com::centreon::concurrency::thread,
+                              public com::centreon::task,
+                              public checks::listener {
+public:
+                     worker(
+                       options const& opts,
+                       checks::listener* listnr = NULL);
+                     ~worker() throw ();
+  void               connect(sessions::credentials const& creds);
+  void               execute(
+                       unsigned long long cmd_id,
+                       time_t timeout,
+                       sessions::credentials const& creds,
+                       std::list<std::string> const& cmds,
+                       int skip_stdout,
+                       int skip_stderr,
+                       bool use_ipv6);
+  void               on_result(checks::result const& r);
+  void               run();
+  void               set_state_file(
+                       sessions::state_file* state) throw ();
+  void               start();
+  void               stop();
+
+protected:
+  void               _run();
+
+private:
+  struct             failure {
+    unsigned int     count;
+    timestamp        retry;
+  };
+
+  struct             order {
+    unsigned long long     cmd_id;
+    std::list<std::string> cmds;
+    sessions::credentials  creds;
+    int                    skip_stderr;
+    int                    skip_stdout;
+    time_t                 timeout;
+    bool                   use_ipv6;
+  };
+
+  struct             queued_session {
+    time_t             deadline;
+    sessions::session* sess;
+    bool               use_ipv6;
+  };
+
+                     worker(worker const& w);
+  worker&            operator=(worker const& w);
+  sessions::session* _bastion_of(
+                       sessions::credentials const& creds,
+                       time_t deadline);
+  void               _clear();
+  void               _delete_session(sessions::session* sess);
+  void               _failed(sessions::credentials const& creds);
+  void               _execute(order const& o);
+  bool               _is_queued(sessions::session* sess) const;
+  bool               _is_used(sessions::session* sess) const;
+  void               _process_orders();
+  void               _queue_session(
+                       sessions::session* sess,
+                       bool use_ipv6,
+                       time_t deadline);
+  void               _reap(unsigned int max);
+  void               _schedule_reaper(bool now = false);
+  void               _start_sessions();
+
+  unsigned int       _backoff_max;
+  unsigned int       _backoff_min;
+  std::map<unsigned long long, std::pair<checks::check*, sessions::session*> >
+                     _checks;
+  std::list<queued_session>
+                     _connect_queue;
+  unsigned int       _connect_rate;
+  unsigned int       _connect_timeout;
+  std::set<sessions::session*>
+                     _connecting;
+  std::map<sessions::credentials, failure>
+                     _failures;
+  unsigned int       _idle_timeout;
+  unsigned int       _keepalive_count;
+  unsigned int       _keepalive_interval;
+  std::map<sessions::session*, timestamp>
+                     _last_used;
+  checks::listener*  _listnr;
+  unsigned int       _max_channels;
+  unsigned int       _max_handshakes;
+  unsigned int       _max_sessions;
+  concurrency::mutex _mutex;
+  std::list<order>   _orders;
+  bool               _parallel_commands;
+  bool               _persistent_shell;
+  bool               _quit;
+  unsigned long      _reaper;
+  std::map<sessions::credentials, sessions::session*>
+                     _sessions;
+  sessions::state_file*
+                     _state;
+  bool               _threaded;
+  timestamp          _tokens_time;
+  double             _tokens;
+  wakeup             _wakeup;
+  std::list<sessions::session*>
+                     _warm_queue;
+};
+
+CCCS_END()
+
+#endif // !CCCS_WORKER_HH
@@ -22,6 +22,7 @@
 #include "com/centreon/connector/ssh/checks/check.hh"
 #include "com/centreon/connector/ssh/checks/timeout.hh"
 #include "com/centreon/connector/ssh/multiplexer.hh"
+#include "com/centreon/connector/ssh/sessions/shell.hh"
 #include "com/centreon/exceptions/basic.hh"
 #include "com/centreon/logging/logger.hh"
 
@@ -42,7 +43,10 @@ using namespace com::centreon::connector::ssh::checks;
 check::check(int skip_stdout, int skip_stderr)
   : _channel(NULL),
     _cmd_id(0),
+    _deadline(0),
     _listnr(NULL),
+    _parallel(false),
+    _pending(0),
     _session(NULL),
     _skip_stderr(skip_stderr),
     _skip_stdout(skip_stdout),
@@ -60,24 +64,23 @@ check::~check() throw () {
     r.set_command_id(_cmd_id);
     _send_result_and_unregister(r);
 
-    if (_channel) {
-      // Close channel (or at least try to). Here libssh2 sucks. When
-      // the close request is received on the remote end, the SSH server
-      // closes the pipes it opened with the target process. It then
-      // waits for it to exits (more or less forced by SIGPIPE if
-      // process writes). However if process does not write we will hang
-      // until it exits (which could be like forever).
-      int ret(LIBSSH2_ERROR_EAGAIN);
-      for (unsigned int i = 0;
-           (i < 32) && (ret == LIBSSH2_ERROR_EAGAIN);
-           ++i) {
-        ret = libssh2_channel_close(_channel);
-        if ((ret == LIBSSH2_ERROR_SOCKET_SEND) && sess)
-          sess->error();
+    // Delete child checks.
+    for (std::vector<check*>::iterator
+           it(_children.begin()), end(_children.end());
+         it != end;
+         ++it)
+      if (*it) {
+        (*it)->unlisten(this);
+        delete *it;
       }
 
-      // Free channel.
-      libssh2_channel_free(_channel);
+    // Let the session close the channel without blocking.
+    if (_channel) {
+      if (sess)
+        sess->close_channel(_channel);
+      else
+        libssh2_channel_free(_channel);
+      _channel = NULL;
     }
   }
   catch (...) {}
@@ -103,7 +106,9 @@ void check::execute(
   // Store command information.
   _cmds = cmds;
   _cmd_id = cmd_id;
+  _deadline = tmt;
   _session = &sess;
+  _step = (sess.get_shell() ? shell_exec : chan_open);
 
   // Register timeout.
   std::auto_ptr<timeout> t(new timeout(this));
@@ -114,10 +119,19 @@ void check::execute(
     true);
   t.release();
 
+  // Commands run on their own channels.
+  if (_parallel && (_cmds.size() > 1)) {
+    _execute_parallel(sess, tmt);
+    return ;
+  }
+
   // Session-related actions.
   sess.listen(this);
-  if (sess.is_connected())
+  if (sess.is_connected()) {
     on_connected(sess);
+    multiplexer::instance().handle_manager::update(
+      sess.get_socket_handle());
+  }
   return ;
 }
 
@@ -182,6 +196,18 @@ void check::on_available(sessions::session& sess) {
         }
       }
       break ;
+    case shell_exec:
+      log_info(logging::high) << "sending check " << _cmd_id
+        << " to persistent shell";
+      {
+        std::string cmd(_cmds.front());
+        _cmds.pop_front();
+        _step = shell_wait;
+        _session->get_shell()->execute(this, cmd);
+      }
+      break ;
+    case shell_wait:
+      break ;
     default:
       throw (basic_error() << "channel requested to run at invalid step");
     }
@@ -234,6 +260,82 @@ void check::on_connected(sessions::session& sess) {
   return ;
 }
 
+/**
+ *  Called when a child check has completed.
+ *
+ *  @param[in] r Result of the child check.
+ */
+void check::on_result(result const& r) {
+  // Delete child, its command ID is its index plus one.
+  unsigned long long index(r.get_command_id() - 1);
+  if ((index >= _children.size()) || !_children[index])
+    return ;
+  check* chk(_children[index]);
+  _children[index] = NULL;
+  chk->unlisten(this);
+  delete chk;
+  _results[index] = r;
+  if (--_pending)
+    return ;
+
+  // All commands have completed, merge their outputs in order.
+  log_debug(logging::medium) << "all commands of check "
+    << _cmd_id << " have completed";
+  int exit_code(0);
+  for (std::vector<result>::const_iterator
+         it(_results.begin()), end(_results.end());
+       it != end;
+       ++it) {
+    if (!it->get_executed()) {
+      result failed;
+      failed.set_command_id(_cmd_id);
+      _send_result_and_unregister(failed);
+      return ;
+    }
+    _stdout.append(it->get_output());
+    _stderr.append(it->get_error());
+    exit_code = it->get_exit_code();
+  }
+  _send_output(exit_code);
+  return ;
+}
+
+/**
+ *  Called when the persistent shell could not execute the command.
+ *
+ *  @param[in] msg Error message.
+ */
+void check::on_shell_error(std::string const& msg) {
+  log_error(logging::low) << "error occured while executing check "
+    << _cmd_id << " in persistent shell: " << msg;
+  _step = shell_exec;
+  result r;
+  r.set_command_id(_cmd_id);
+  _send_result_and_unregister(r);
+  return ;
+}
+
+/**
+ *  Called when the persistent shell executed the command.
+ *
+ *  @param[in] out       Command output.
+ *  @param[in] err       Command error output.
+ *  @param[in] exit_code Command exit code.
+ */
+void check::on_shell_result(
+              std::string const& out,
+              std::string const& err,
+              int exit_code) {
+  _stdout.append(out);
+  _stderr.append(err);
+  _step = shell_exec;
+  if (_cmds.empty())
+    _send_output(exit_code);
+  else
+    on_available(*_session);
+  return ;
+}
+
 /**
  *  Called when check timeout occurs.
  */
@@ -253,6 +355,16 @@ void check::on_timeout() {
   return ;
 }
 
+/**
+ *  Run multiple commands in parallel.
+ *
+ *  @param[in] parallel true to run each command on its own channel.
+ */
+void check::set_parallel(bool parallel) throw () {
+  _parallel = parallel;
+  return ;
+}
+
 /**
  *  Stop listening to the check.
  *
@@ -309,21 +421,10 @@ bool check::_close() {
       // Method should not be called again.
       retval = false;
 
-      if (_skip_stdout != -1)
-        _skip_data(_stdout, _skip_stdout);
-      if (_skip_stderr != -1)
-        _skip_data(_stderr, _skip_stderr);
-
-      // Send results to parent process.
-      if (_cmds.empty()) {
-        result r;
-        r.set_command_id(_cmd_id);
-        r.set_error(_stderr);
-        r.set_executed(true);
-        r.set_exit_code(exitcode);
-        r.set_output(_stdout);
-        _send_result_and_unregister(r);
-      }
+      // Send results to parent process. Unregistering from session
+      // releases the channel slot, starting the next queued check.
+      if (_cmds.empty())
+        _send_output(exitcode);
       else {
 	_step = chan_open;
 	on_available(*_session);
@@ -373,12 +474,52 @@ bool check::_exec() {
   return (retval);
 }
 
+/**
+ *  Run each command in a child check.
+ *
+ *  @param[in] sess Session on which channels will be opened.
+ *  @param[in] tmt  Command timeout.
+ */
+void check::_execute_parallel(sessions::session& sess, time_t tmt) {
+  log_debug(logging::medium) << "running " << _cmds.size()
+    << " commands of check " << _cmd_id << " in parallel";
+
+  // Create child checks.
+  for (unsigned int i(0); i < _cmds.size(); ++i) {
+    std::auto_ptr<check> chk(new check);
+    chk->listen(this);
+    _children.push_back(chk.get());
+    chk.release();
+  }
+  _results.resize(_children.size());
+  _pending = _children.size();
+
+  // Run copies, we are deleted when the last child completes.
+  std::vector<check*> children(_children);
+  std::list<std::string> cmds;
+  cmds.swap(_cmds);
+  unsigned long long i(0);
+  for (std::list<std::string>::const_iterator
+         it(cmds.begin()), end(cmds.end());
+       it != end;
+       ++it, ++i)
+    children[i]->execute(
+                   sess,
+                   i + 1,
+                   std::list<std::string>(1, *it),
+                   tmt);
+  return ;
+}
+
 /**
  *  Attempt to open a channel.
  *
  *  @return true while the channel was not successfully opened.
  */
 bool check::_open() {
+  // Wait for a channel slot on the session.
+  if (!_session->acquire_channel(this, _deadline))
+    return (true);
   _channel = _session->new_channel();
   return (!_channel);
 }
@@ -425,6 +566,26 @@ bool check::_read() {
           && !libssh2_channel_eof(_channel));
 }
 
+/**
+ *  Send the output of executed commands.
+ *
+ *  @param[in] exit_code Exit code of the last command.
+ */
+void check::_send_output(int exit_code) {
+  if (_skip_stdout != -1)
+    _skip_data(_stdout, _skip_stdout);
+  if (_skip_stderr != -1)
+    _skip_data(_stderr, _skip_stderr);
+  result r;
+  r.set_command_id(_cmd_id);
+  r.set_error(_stderr);
+  r.set_executed(true);
+  r.set_exit_code(exit_code);
+  r.set_output(_stdout);
+  _send_result_and_unregister(r);
+  return ;
+}
+
 /**
  *  Send check result and unregister from session.
  *
@@ -443,6 +604,10 @@ void check::_send_result_and_unregister(result const& r) {
 
   // Check that session is valid.
   if (_session) {
+    // Withdraw command from the persistent shell.
+    if ((_step == shell_wait) && _session->get_shell())
+      _session->get_shell()->cancel(this);
+
     // Unregister from session.
     log_debug(logging::high) << "check " << this
       << " is unregistering from session " << _session;
@@ -0,0 +1,138 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include "com/centreon/connector/ssh/checks/coalescer.hh"
+
+using namespace com::centreon::connector::ssh::checks;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ */
+coalescer::coalescer() {}
+
+/**
+ *  Destructor.
+ */
+coalescer::~coalescer() throw () {}
+
+/**
+ *  @brief Attach a check to a running identical check.
+ *
+ *  A check that is not attached must be executed. If no identical
+ *  check is running, it becomes the leader of later identical checks.
+ *
+ *  @param[in] cmd_id   Command ID.
+ *  @param[in] k        Check key.
+ *  @param[in] deadline Absolute time at which the check times out.
+ *
+ *  @return true if the check will get the result of a running check.
+ */
+bool coalescer::attach(
+                  unsigned long long cmd_id,
+                  key const& k,
+                  time_t deadline) {
+  std::map<key, group>::iterator it(_groups.find(k));
+  if (it == _groups.end()) {
+    _groups[k].deadline = deadline;
+    _leaders[cmd_id] = k;
+    return (false);
+  }
+  if (it->second.deadline > deadline)
+    return (false);
+  it->second.followers.insert(std::make_pair(deadline, cmd_id));
+  return (true);
+}
+
+/**
+ *  @brief Get the checks attached to a check that completed.
+ *
+ *  Attached checks get a copy of the result, unless the check could
+ *  not be executed (it timed out for example) while they still have
+ *  time left. These must be executed again.
+ *
+ *  @param[in]  cmd_id   Command ID of the completed check.
+ *  @param[in]  executed Whether the completed check was executed.
+ *  @param[in]  now      Current time.
+ *  @param[out] k        Key of the completed check.
+ *  @param[out] copies   Command IDs of the checks that get a copy of
+ *                       the result.
+ *  @param[out] retries  Command IDs of the checks to execute again,
+ *                       by deadline.
+ *
+ *  @return true if some checks were attached to the completed check.
+ */
+bool coalescer::detach(
+                  unsigned long long cmd_id,
+                  bool executed,
+                  time_t now,
+                  key& k,
+                  std::list<unsigned long long>& copies,
+                  std::multimap<time_t, unsigned long long>& retries) {
+  std::map<unsigned long long, key>::iterator
+    leader(_leaders.find(cmd_id));
+  if (leader == _leaders.end())
+    return (false);
+  bool retval(false);
+  std::map<key, group>::iterator it(_groups.find(leader->second));
+  if (it != _groups.end()) {
+    retval = !it->second.followers.empty();
+    for (std::multimap<time_t, unsigned long long>::const_iterator
+           follower(it->second.followers.begin()),
+           end(it->second.followers.end());
+         follower != end;
+         ++follower)
+      if (executed || (follower->first <= now))
+        copies.push_back(follower->second);
+      else
+        retries.insert(*follower);
+    k = it->first;
+    _groups.erase(it);
+  }
+  _leaders.erase(leader);
+  return (retval);
+}
+
+/**
+ *  Compare check keys.
+ *
+ *  @param[in] k Object to compare to.
+ *
+ *  @return true if this object is strictly less than k.
+ */
+bool coalescer::key::operator<(key const& k) const {
+  bool retval;
+  if (creds < k.creds)
+    retval = true;
+  else if (k.creds < creds)
+    retval = false;
+  else if (cmds != k.cmds)
+    retval = (cmds < k.cmds);
+  else if (skip_stdout != k.skip_stdout)
+    retval = (skip_stdout < k.skip_stdout);
+  else if (skip_stderr != k.skip_stderr)
+    retval = (skip_stderr < k.skip_stderr);
+  else
+    retval = (use_ipv6 < k.use_ipv6);
+  return (retval);
+}
@@ -0,0 +1,146 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstring>
+#include "com/centreon/connector/ssh/dns/listener.hh"
+#include "com/centreon/connector/ssh/dns/lookup.hh"
+
+using namespace com::centreon::connector::ssh;
+using namespace com::centreon::connector::ssh::dns;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] host   Host to resolve.
+ *  @param[in] family Address family (AF_INET or AF_INET6).
+ *  @param[in] listnr Listener that will be notified of the result.
+ *  @param[in] target Multiplexer in which the listener is notified.
+ */
+lookup::lookup(
+          std::string const& host,
+          int family,
+          listener* listnr,
+          multiplexer* target)
+  : _addrlen(0),
+    _family(family),
+    _host(host),
+    _listnr(listnr),
+    _target(target) {
+  memset(&_addr, 0, sizeof(_addr));
+}
+
+/**
+ *  Destructor.
+ */
+lookup::~lookup() throw () {}
+
+/**
+ *  Get the address family.
+ *
+ *  @return AF_INET or AF_INET6.
+ */
+int lookup::get_family() const throw () {
+  return (_family);
+}
+
+/**
+ *  Get the host to resolve.
+ *
+ *  @return Host name.
+ */
+std::string const& lookup::get_host() const throw () {
+  return (_host);
+}
+
+/**
+ *  Get the multiplexer in which the listener is notified.
+ *
+ *  @return Target multiplexer, NULL if lookup was cancelled.
+ */
+multiplexer* lookup::get_target() const throw () {
+  return (_target);
+}
+
+/**
+ *  Notify listener of the lookup result.
+ */
+void lookup::run() {
+  if (_listnr) {
+    listener* listnr(_listnr);
+    _listnr = NULL;
+    if (_addrlen)
+      listnr->on_resolved(
+        reinterpret_cast<sockaddr const*>(&_addr),
+        _addrlen);
+    else
+      listnr->on_resolve_error(_error);
+  }
+  return ;
+}
+
+/**
+ *  Set lookup error.
+ *
+ *  @param[in] msg Error message.
+ */
+void lookup::set_error(std::string const& msg) {
+  _addrlen = 0;
+  _error = msg;
+  return ;
+}
+
+/**
+ *  Set the listener.
+ *
+ *  @param[in] listnr New listener.
+ */
+void lookup::set_listener(listener* listnr) throw () {
+  _listnr = listnr;
+  return ;
+}
+
+/**
+ *  Set the resolved address.
+ *
+ *  @param[in] addr    Address.
+ *  @param[in] addrlen Address length.
+ */
+void lookup::set_result(sockaddr const* addr, socklen_t addrlen) {
+  if (addrlen > sizeof(_addr))
+    addrlen = sizeof(_addr);
+  memcpy(&_addr, addr, addrlen);
+  _addrlen = addrlen;
+  _error.clear();
+  return ;
+}
+
+/**
+ *  Set the multiplexer in which the listener is notified.
+ *
+ *  @param[in] target Multiplexer.
+ */
+void lookup::set_target(multiplexer* target) throw () {
+  _target = target;
+  return ;
+}
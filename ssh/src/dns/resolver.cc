@@ -0,0 +1,354 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sstream>
+#include "com/centreon/concurrency/locker.hh"
+#include "com/centreon/connector/ssh/dns/lookup.hh"
+#include "com/centreon/connector/ssh/dns/resolver.hh"
+#include "com/centreon/connector/ssh/multiplexer.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::ssh;
+using namespace com::centreon::connector::ssh::dns;
+
+// Class instance pointer.
+static resolver* _instance = NULL;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Destructor.
+ */
+resolver::~resolver() throw () {
+  // Stop threads.
+  {
+    concurrency::locker lock(&_mutex);
+    _quit = true;
+    _cv.wake_all();
+  }
+  for (std::vector<resolver_thread*>::iterator
+         it(_threads.begin()), end(_threads.end());
+       it != end;
+       ++it) {
+    (*it)->wait();
+    delete *it;
+  }
+  _threads.clear();
+
+  // Delete pending lookups.
+  for (std::list<lookup*>::iterator
+         it(_pending.begin()), end(_pending.end());
+       it != end;
+       ++it)
+    delete *it;
+  _pending.clear();
+}
+
+/**
+ *  @brief Cancel a lookup.
+ *
+ *  Its listener will not be notified. This method must be called
+ *  from the thread that requested the lookup.
+ *
+ *  @param[in] l Lookup returned by resolve().
+ */
+void resolver::cancel(lookup* l) {
+  concurrency::locker lock(&_mutex);
+  std::list<lookup*>::iterator it(
+    std::find(_pending.begin(), _pending.end(), l));
+  if (it != _pending.end()) {
+    _pending.erase(it);
+    delete l;
+  }
+  else {
+    // Lookup is being resolved or was already posted.
+    l->set_listener(NULL);
+    l->set_target(NULL);
+  }
+  return ;
+}
+
+/**
+ *  Look for a host address in the cache.
+ *
+ *  @param[in]  host    Host name.
+ *  @param[in]  family  Address family (AF_INET or AF_INET6).
+ *  @param[out] addr    Cached address.
+ *  @param[out] addrlen Cached address length.
+ *
+ *  @return true if address was found in cache. An exception is thrown
+ *          if a recent resolution of this host failed.
+ */
+bool resolver::find(
+                 std::string const& host,
+                 int family,
+                 sockaddr_storage& addr,
+                 socklen_t& addrlen) {
+  concurrency::locker lock(&_mutex);
+  std::map<std::pair<std::string, int>, entry>::iterator
+    it(_cache.find(std::make_pair(host, family)));
+  if (it == _cache.end())
+    return (false);
+  if (it->second.expiry <= timestamp::now()) {
+    _cache.erase(it);
+    return (false);
+  }
+  if (!it->second.addrlen)
+    throw (basic_error() << it->second.error << " (cached)");
+  memcpy(&addr, &it->second.addr, it->second.addrlen);
+  addrlen = it->second.addrlen;
+  return (true);
+}
+
+/**
+ *  Get class instance.
+ *
+ *  @return Resolver instance.
+ */
+resolver& resolver::instance() throw () {
+  return (*_instance);
+}
+
+/**
+ *  Load singleton.
+ *
+ *  @param[in] ttl          Number of seconds successful resolutions
+ *                          are cached (0 to disable).
+ *  @param[in] negative_ttl Number of seconds failed resolutions are
+ *                          cached (0 to disable).
+ *  @param[in] threads      Number of resolution threads.
+ */
+void resolver::load(
+                 unsigned int ttl,
+                 unsigned int negative_ttl,
+                 unsigned int threads) {
+  if (!_instance)
+    _instance = new resolver(ttl, negative_ttl, threads);
+  return ;
+}
+
+/**
+ *  @brief Resolve a host name asynchronously.
+ *
+ *  The listener will be notified in the calling thread, through its
+ *  multiplexer.
+ *
+ *  @param[in] host   Host name.
+ *  @param[in] family Address family (AF_INET or AF_INET6).
+ *  @param[in] listnr Listener.
+ *
+ *  @return Lookup object that can be used to cancel the request.
+ */
+lookup* resolver::resolve(
+                    std::string const& host,
+                    int family,
+                    listener* listnr) {
+  std::auto_ptr<lookup>
+    l(new lookup(host, family, listnr, &multiplexer::instance()));
+  concurrency::locker lock(&_mutex);
+  _pending.push_back(l.get());
+  _cv.wake_one();
+  return (l.release());
+}
+
+/**
+ *  Unload singleton.
+ */
+void resolver::unload() {
+  delete _instance;
+  _instance = NULL;
+  return ;
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] ttl          Number of seconds successful resolutions
+ *                          are cached.
+ *  @param[in] negative_ttl Number of seconds failed resolutions are
+ *                          cached.
+ *  @param[in] threads      Number of resolution threads.
+ */
+resolver::resolver(
+            unsigned int ttl,
+            unsigned int negative_ttl,
+            unsigned int threads)
+  : _negative_ttl(negative_ttl),
+    _next_purge(timestamp::now()),
+    _quit(false),
+    _ttl(ttl) {
+  if (!threads)
+    threads = 1;
+  for (unsigned int i(0); i < threads; ++i) {
+    std::auto_ptr<resolver_thread> th(new resolver_thread(this));
+    th->exec();
+    _threads.push_back(th.release());
+  }
+}
+
+/**
+ *  Resolution threads main loop.
+ */
+void resolver::_process() {
+  concurrency::locker lock(&_mutex);
+  for (;;) {
+    while (!_quit && _pending.empty())
+      _cv.wait(&_mutex);
+    if (_quit)
+      break ;
+    lookup* l(_pending.front());
+    _pending.pop_front();
+
+    // Resolve without holding the lock.
+    lock.unlock();
+    entry e;
+    _resolve(l->get_host(), l->get_family(), e);
+    if (e.addrlen)
+      l->set_result(reinterpret_cast<sockaddr*>(&e.addr), e.addrlen);
+    else
+      l->set_error(e.error);
+    lock.relock();
+
+    // Cache result.
+    unsigned int ttl(e.addrlen ? _ttl : _negative_ttl);
+    if (ttl) {
+      timestamp now(timestamp::now());
+      _purge(now);
+      e.expiry = now;
+      e.expiry.add_seconds(ttl);
+      _cache[std::make_pair(l->get_host(), l->get_family())] = e;
+    }
+
+    // Notify requester or delete cancelled lookup.
+    if (l->get_target())
+      l->get_target()->post(l);
+    else
+      delete l;
+  }
+  return ;
+}
+
+/**
+ *  Remove expired entries from cache. This is done at most once per
+ *  second.
+ *
+ *  @param[in] now Current time.
+ */
+void resolver::_purge(timestamp const& now) {
+  if (now < _next_purge)
+    return ;
+  std::map<std::pair<std::string, int>, entry>::iterator
+    it(_cache.begin());
+  while (it != _cache.end()) {
+    if (it->second.expiry <= now)
+      _cache.erase(it++);
+    else
+      ++it;
+  }
+  _next_purge = now;
+  _next_purge.add_seconds(1);
+  return ;
+}
+
+/**
+ *  Resolve a host name.
+ *
+ *  @param[in]  host   Host name.
+ *  @param[in]  family Address family (AF_INET or AF_INET6).
+ *  @param[out] e      Resolution result.
+ */
+void resolver::_resolve(
+                 std::string const& host,
+                 int family,
+                 entry& e) {
+  memset(&e.addr, 0, sizeof(e.addr));
+  e.addrlen = 0;
+  log_debug(logging::low) << "resolving host " << host;
+  addrinfo hint;
+  memset(&hint, 0, sizeof(hint));
+  hint.ai_family = family;
+  hint.ai_socktype = SOCK_STREAM;
+  addrinfo* res(NULL);
+  int retval(getaddrinfo(host.c_str(), NULL, &hint, &res));
+  if (retval) {
+    std::ostringstream oss;
+    oss << "lookup of host '" << host << "' failed: "
+        << gai_strerror(retval);
+    e.error = oss.str();
+  }
+  else if (!res) {
+    std::ostringstream oss;
+    oss << "no IPv" << ((family == AF_INET6) ? "6" : "4")
+        << " address found for host '" << host << "'";
+    e.error = oss.str();
+  }
+  else {
+    log_debug(logging::low) << "found host " << host
+      << " address through name resolution";
+    if (res->ai_addrlen <= sizeof(e.addr)) {
+      memcpy(&e.addr, res->ai_addr, res->ai_addrlen);
+      e.addrlen = res->ai_addrlen;
+    }
+    freeaddrinfo(res);
+  }
+  return ;
+}
+
+/**************************************
+*                                     *
+*           resolver_thread           *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] r Resolver.
+ */
+resolver::resolver_thread::resolver_thread(resolver* r)
+  : _resolver(r) {}
+
+/**
+ *  Destructor.
+ */
+resolver::resolver_thread::~resolver_thread() throw () {}
+
+/**
+ *  Thread entry point.
+ */
+void resolver::resolver_thread::_run() {
+  _resolver->_process();
+  return ;
+}
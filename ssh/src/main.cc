@@ -25,9 +25,12 @@
 #endif // LIBSSH2_WITH_LIBGCRYPT
 #include <iostream>
 #include <libssh2.h>
+#include "com/centreon/connector/ssh/dns/resolver.hh"
 #include "com/centreon/connector/ssh/multiplexer.hh"
 #include "com/centreon/connector/ssh/options.hh"
 #include "com/centreon/connector/ssh/policy.hh"
+#include "com/centreon/connector/ssh/sessions/key_cache.hh"
+#include "com/centreon/connector/ssh/sessions/known_hosts.hh"
 #include "com/centreon/exceptions/basic.hh"
 #include "com/centreon/logging/file.hh"
 #include "com/centreon/logging/logger.hh"
@@ -160,8 +163,15 @@ int main(int argc, char* argv[]) {
         << "installing termination handler";
       signal(SIGTERM, term_handler);
 
+      // Name resolution.
+      dns::resolver::load(
+                       opts.get_dns_ttl(),
+                       opts.get_dns_negative_ttl());
+      sessions::key_cache::load();
+      sessions::known_hosts::load();
+
       // Program policy.
-      policy p;
+      policy p(opts);
       retval = (p.run() ? EXIT_SUCCESS : EXIT_FAILURE);
     }
   }
@@ -175,6 +185,9 @@ int main(int argc, char* argv[]) {
 #endif /* libssh2 version >= 1.2.5 */
 
   // Deinitializations.
+  sessions::known_hosts::unload();
+  sessions::key_cache::unload();
+  dns::resolver::unload();
   multiplexer::unload();
   logging::engine::unload();
   if (log_file)
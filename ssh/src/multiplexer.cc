@@ -1,5 +1,5 @@
 /*
-** Copyright 2011-2013 Centreon
+** Copyright 2011-2013,2019 Centreon
 **
 ** Licensed under the Apache License, Version 2.0 (the "License");
 ** you may not use this file except in compliance with the License.
@@ -18,11 +18,13 @@
 
 #include <cstdlib>
 #include "com/centreon/connector/ssh/multiplexer.hh"
+#include "com/centreon/timestamp.hh"
 
 using namespace com::centreon::connector::ssh;
 
-// Class instance pointer.
-static multiplexer* _instance = NULL;
+// Class instance pointer. Every thread running a reactor loads its
+// own multiplexer, so the instance is thread-specific.
+static __thread multiplexer* _instance = NULL;
 
 /**************************************
 *                                     *
@@ -33,10 +35,12 @@ static multiplexer* _instance = NULL;
 /**
  *  Destructor.
  */
-multiplexer::~multiplexer() throw () {}
+multiplexer::~multiplexer() throw () {
+  handle_manager::remove(static_cast<handle*>(&_wakeup));
+}
 
 /**
- *  Get class instance.
+ *  Get class instance of the calling thread.
  *
  *  @return multiplexer instance.
  */
@@ -45,7 +49,7 @@ multiplexer& multiplexer::instance() throw () {
 }
 
 /**
- *  Load singleton.
+ *  Load singleton of the calling thread.
  */
 void multiplexer::load() {
   if (!_instance)
@@ -54,7 +58,22 @@ void multiplexer::load() {
 }
 
 /**
- *  Unload singleton.
+ *  @brief Execute a task as soon as possible in the multiplexing
+ *  thread.
+ *
+ *  This method can be called from any thread. The multiplexer takes
+ *  ownership of the task.
+ *
+ *  @param[in] t Task to execute.
+ */
+void multiplexer::post(com::centreon::task* t) {
+  task_manager::add(t, timestamp::now(), false, true);
+  _wakeup.wake();
+  return ;
+}
+
+/**
+ *  Unload singleton of the calling thread.
  */
 void multiplexer::unload() {
   delete _instance;
@@ -72,4 +91,6 @@ void multiplexer::unload() {
  *  Default constructor.
  */
 multiplexer::multiplexer()
-  : com::centreon::handle_manager(this) {}
+  : handle_manager(this) {
+  handle_manager::add(&_wakeup, &_wakeup);
+}
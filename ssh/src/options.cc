@@ -16,21 +16,81 @@
 ** For more information : contact@centreon.com
 */
 
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 #include <sstream>
 #include "com/centreon/connector/ssh/orders/options.hh"
 #include "com/centreon/connector/ssh/options.hh"
+#include "com/centreon/exceptions/basic.hh"
 
 using namespace com::centreon::connector::ssh;
 
 // Options descriptions.
+static char const* const backoff_max_description
+  = "Maximum number of seconds checks of an unreachable host fail "
+    "immediately (default: 300).";
+static char const* const backoff_min_description
+  = "Number of seconds checks of a host fail immediately after a "
+    "connection failure, doubled on each new failure (default: 0, "
+    "disabled).";
+static char const* const coalesce_checks_description
+  = "Checks identical to a running check get a copy of its result "
+    "instead of being executed again (default: disabled).";
+static char const* const connect_rate_description
+  = "Maximum number of SSH sessions connected per second, checks of "
+    "extra sessions wait (default: 0, no limit).";
+static char const* const connect_timeout_description
+  = "Number of seconds a SSH session has to connect and authenticate, "
+    "checks waiting on it fail afterwards (default: 0, bounded by the "
+    "check timeout).";
 static char const* const debug_description
   = "If this flag is specified, print all logs messages.";
+static char const* const dns_negative_ttl_description
+  = "Number of seconds a failed host name resolution is cached "
+    "(default: 10, 0 to disable).";
+static char const* const dns_ttl_description
+  = "Number of seconds a resolved host address is cached "
+    "(default: 60, 0 to disable).";
 static char const* const help_description
   = "Print help and exit.";
+static char const* const parallel_commands_description
+  = "Execute the commands of a check that has more than one of them "
+    "simultaneously, on separate channels (default: disabled).";
+static char const* const persistent_shell_description
+  = "Execute checks of a SSH session one after another in a "
+    "persistent remote shell instead of opening a channel for each of "
+    "them (default: disabled).";
+static char const* const state_file_description
+  = "File where SSH sessions open on exit are saved, to connect them "
+    "in advance on next start. Sessions using a password are not "
+    "saved (default: none).";
 static char const* const version_description
   = "Print software version and exit.";
+static char const* const idle_timeout_description
+  = "Close SSH sessions that did not run any check for this number "
+    "of seconds (default: 0, sessions are kept open).";
+static char const* const keepalive_count_description
+  = "Number of unacknowledged keepalive messages after which a SSH "
+    "session is considered dead (default: 3, 0 to let the system "
+    "decide).";
+static char const* const keepalive_interval_description
+  = "Number of seconds between keepalive messages sent on idle SSH "
+    "sessions (default: 30, 0 to disable).";
 static char const* const log_file_description
   = "Specifies the log file (default: stderr).";
+static char const* const max_channels_description
+  = "Maximum number of channels opened simultaneously on a SSH "
+    "session, extra checks wait for a channel to close (default: 10).";
+static char const* const max_handshakes_description
+  = "Maximum number of SSH sessions connecting simultaneously, checks "
+    "of extra sessions wait (default: 0, no limit).";
+static char const* const max_sessions_description
+  = "Maximum number of SSH sessions kept open, least recently used "
+    "idle sessions are closed first (default: 0, no limit).";
+static char const* const workers_description
+  = "Number of threads executing checks (default: 0, checks are "
+    "executed by the main thread).";
 
 /**************************************
 *                                     *
@@ -72,16 +132,201 @@ options& options::operator=(options const& opts) {
   return (*this);
 }
 
+/**
+ *  Get the maximum backoff delay of unreachable hosts.
+ *
+ *  @return Number of seconds.
+ */
+unsigned int options::get_backoff_max() const {
+  return (_get_unsigned('B', 300));
+}
+
+/**
+ *  Get the initial backoff delay of unreachable hosts.
+ *
+ *  @return Number of seconds, 0 if backoff is disabled.
+ */
+unsigned int options::get_backoff_min() const {
+  return (_get_unsigned('b', 0));
+}
+
+/**
+ *  Check whether identical checks should be coalesced.
+ *
+ *  @return true if identical checks share a single execution.
+ */
+bool options::get_coalesce_checks() const {
+  return (get_argument('C').get_is_set());
+}
+
+/**
+ *  Get the connection rate of sessions.
+ *
+ *  @return Maximum number of sessions connected per second, 0 if
+ *          unlimited.
+ */
+unsigned int options::get_connect_rate() const {
+  return (_get_unsigned('r', 0));
+}
+
+/**
+ *  Get the connect timeout of sessions.
+ *
+ *  @return Number of seconds a session has to connect and
+ *          authenticate, 0 if only bounded by check timeouts.
+ */
+unsigned int options::get_connect_timeout() const {
+  return (_get_unsigned('T', 0));
+}
+
+/**
+ *  Get the time failed host name resolutions are cached.
+ *
+ *  @return Number of seconds, 0 if failures are not cached.
+ */
+unsigned int options::get_dns_negative_ttl() const {
+  return (_get_unsigned('n', 10));
+}
+
+/**
+ *  Get the time resolved host addresses are cached.
+ *
+ *  @return Number of seconds, 0 if addresses are not cached.
+ */
+unsigned int options::get_dns_ttl() const {
+  return (_get_unsigned('t', 60));
+}
+
+/**
+ *  Get the idle timeout of sessions.
+ *
+ *  @return Number of seconds after which an idle session is closed,
+ *          0 if idle sessions are kept open.
+ */
+unsigned int options::get_idle_timeout() const {
+  return (_get_unsigned('i', 0));
+}
+
+/**
+ *  Get the number of unacknowledged keepalive messages.
+ *
+ *  @return Number of keepalive messages after which a session is
+ *          dead, 0 if it is up to the system.
+ */
+unsigned int options::get_keepalive_count() const {
+  return (_get_unsigned('K', 3));
+}
+
+/**
+ *  Get the keepalive interval of sessions.
+ *
+ *  @return Number of seconds between keepalive messages, 0 if
+ *          keepalive is disabled.
+ */
+unsigned int options::get_keepalive_interval() const {
+  return (_get_unsigned('k', 30));
+}
+
+/**
+ *  Get the maximum number of channels per session.
+ *
+ *  @return Maximum number of channels opened simultaneously on a
+ *          session.
+ */
+unsigned int options::get_max_channels() const {
+  unsigned int retval(_get_unsigned('c', 10));
+  if (!retval)
+    throw (basic_error() << "max-channels must be greater than 0");
+  return (retval);
+}
+
+/**
+ *  Get the maximum number of simultaneous handshakes.
+ *
+ *  @return Maximum number of sessions being connected at the same
+ *          time, 0 if unlimited.
+ */
+unsigned int options::get_max_handshakes() const {
+  return (_get_unsigned('m', 0));
+}
+
+/**
+ *  Get the maximum number of open sessions.
+ *
+ *  @return Maximum number of open sessions, 0 if unlimited.
+ */
+unsigned int options::get_max_sessions() const {
+  return (_get_unsigned('s', 0));
+}
+
+/**
+ *  Check whether commands of a check should be run in parallel.
+ *
+ *  @return true if each command of a check runs on its own channel.
+ */
+bool options::get_parallel_commands() const {
+  return (get_argument('P').get_is_set());
+}
+
+/**
+ *  Check whether checks should be executed by persistent shells.
+ *
+ *  @return true if each session runs its checks in a persistent
+ *          remote shell.
+ */
+bool options::get_persistent_shell() const {
+  return (get_argument('S').get_is_set());
+}
+
+/**
+ *  Get the path of the sessions state file.
+ *
+ *  @return State file path, empty if sessions should not be saved.
+ */
+std::string options::get_state_file() const {
+  misc::argument const& arg(get_argument('f'));
+  return (arg.get_is_set() ? arg.get_value() : "");
+}
+
+/**
+ *  Get the number of worker threads.
+ *
+ *  @return Number of worker threads, 0 if checks should be executed
+ *          by the main thread.
+ */
+unsigned int options::get_workers() const {
+  return (_get_unsigned('w', 0));
+}
+
 /**
  *  Get the help.
  */
 std::string options::help() const {
   std::ostringstream oss;
   oss << "centreon_connector_ssh [args]\n"
+      << "  --backoff-max " << backoff_max_description << "\n"
+      << "  --backoff-min " << backoff_min_description << "\n"
+      << "  --coalesce-checks " << coalesce_checks_description << "\n"
+      << "  --connect-rate " << connect_rate_description << "\n"
+      << "  --connect-timeout " << connect_timeout_description << "\n"
       << "  --debug    " << debug_description << "\n"
+      << "  --dns-negative-ttl " << dns_negative_ttl_description << "\n"
+      << "  --dns-ttl  " << dns_ttl_description << "\n"
       << "  --help     " << help_description << "\n"
+      << "  --idle-timeout " << idle_timeout_description << "\n"
+      << "  --keepalive " << keepalive_interval_description << "\n"
+      << "  --keepalive-count " << keepalive_count_description << "\n"
       << "  --version  " << version_description << "\n"
       << "  --log-file " << log_file_description << "\n"
+      << "  --max-channels " << max_channels_description << "\n"
+      << "  --max-handshakes " << max_handshakes_description << "\n"
+      << "  --max-sessions " << max_sessions_description << "\n"
+      << "  --parallel-commands " << parallel_commands_description
+      << "\n"
+      << "  --persistent-shell " << persistent_shell_description
+      << "\n"
+      << "  --state-file " << state_file_description << "\n"
+      << "  --workers  " << workers_description << "\n"
       << "\n"
       << "Commands must be sent on the connector's standard input.\n"
       << "They must be sent using Centreon Connector protocol version\n"
@@ -118,10 +363,85 @@ std::string options::usage() const {
 *                                     *
 **************************************/
 
+/**
+ *  Get the value of an unsigned integer argument.
+ *
+ *  @param[in] name          Argument short name.
+ *  @param[in] default_value Value returned if argument is not set.
+ *
+ *  @return Argument value.
+ */
+unsigned int options::_get_unsigned(
+                        char name,
+                        unsigned int default_value) const {
+  std::map<char, misc::argument>::const_iterator
+    it(_arguments.find(name));
+  if ((it == _arguments.end()) || !it->second.get_is_set())
+    return (default_value);
+  // strtoul() accepts signs and leading spaces, negative values
+  // would wrap around.
+  char* end(NULL);
+  char const* value(it->second.get_value().c_str());
+  errno = 0;
+  unsigned long retval(strtoul(value, &end, 10));
+  if ((*value < '0')
+      || (*value > '9')
+      || *end
+      || (errno == ERANGE)
+      || (retval > UINT_MAX))
+    throw (basic_error() << "invalid value '" << value
+           << "' for argument '" << it->second.get_long_name() << "'");
+  return (retval);
+}
+
 /**
  *  Init argument table.
  */
 void options::_init() {
+  // Backoff max.
+  {
+    misc::argument& arg(_arguments['B']);
+    arg.set_name('B');
+    arg.set_long_name("backoff-max");
+    arg.set_description(backoff_max_description);
+    arg.set_has_value(true);
+  }
+
+  // Backoff min.
+  {
+    misc::argument& arg(_arguments['b']);
+    arg.set_name('b');
+    arg.set_long_name("backoff-min");
+    arg.set_description(backoff_min_description);
+    arg.set_has_value(true);
+  }
+
+  // Coalesce checks.
+  {
+    misc::argument& arg(_arguments['C']);
+    arg.set_name('C');
+    arg.set_long_name("coalesce-checks");
+    arg.set_description(coalesce_checks_description);
+  }
+
+  // Connect rate.
+  {
+    misc::argument& arg(_arguments['r']);
+    arg.set_name('r');
+    arg.set_long_name("connect-rate");
+    arg.set_description(connect_rate_description);
+    arg.set_has_value(true);
+  }
+
+  // Connect timeout.
+  {
+    misc::argument& arg(_arguments['T']);
+    arg.set_name('T');
+    arg.set_long_name("connect-timeout");
+    arg.set_description(connect_timeout_description);
+    arg.set_has_value(true);
+  }
+
   // Debug.
   {
     misc::argument& arg(_arguments['d']);
@@ -130,6 +450,24 @@ void options::_init() {
     arg.set_description(debug_description);
   }
 
+  // DNS negative TTL.
+  {
+    misc::argument& arg(_arguments['n']);
+    arg.set_name('n');
+    arg.set_long_name("dns-negative-ttl");
+    arg.set_description(dns_negative_ttl_description);
+    arg.set_has_value(true);
+  }
+
+  // DNS TTL.
+  {
+    misc::argument& arg(_arguments['t']);
+    arg.set_name('t');
+    arg.set_long_name("dns-ttl");
+    arg.set_description(dns_ttl_description);
+    arg.set_has_value(true);
+  }
+
   // Help.
   {
     misc::argument& arg(_arguments['h']);
@@ -138,6 +476,33 @@ void options::_init() {
     arg.set_description(help_description);
   }
 
+  // Idle timeout.
+  {
+    misc::argument& arg(_arguments['i']);
+    arg.set_name('i');
+    arg.set_long_name("idle-timeout");
+    arg.set_description(idle_timeout_description);
+    arg.set_has_value(true);
+  }
+
+  // Keepalive count.
+  {
+    misc::argument& arg(_arguments['K']);
+    arg.set_name('K');
+    arg.set_long_name("keepalive-count");
+    arg.set_description(keepalive_count_description);
+    arg.set_has_value(true);
+  }
+
+  // Keepalive interval.
+  {
+    misc::argument& arg(_arguments['k']);
+    arg.set_name('k');
+    arg.set_long_name("keepalive");
+    arg.set_description(keepalive_interval_description);
+    arg.set_has_value(true);
+  }
+
   // Version.
   {
     misc::argument& arg(_arguments['v']);
@@ -155,5 +520,66 @@ void options::_init() {
     arg.set_has_value(true);
   }
 
+  // Max channels.
+  {
+    misc::argument& arg(_arguments['c']);
+    arg.set_name('c');
+    arg.set_long_name("max-channels");
+    arg.set_description(max_channels_description);
+    arg.set_has_value(true);
+  }
+
+  // Max handshakes.
+  {
+    misc::argument& arg(_arguments['m']);
+    arg.set_name('m');
+    arg.set_long_name("max-handshakes");
+    arg.set_description(max_handshakes_description);
+    arg.set_has_value(true);
+  }
+
+  // Max sessions.
+  {
+    misc::argument& arg(_arguments['s']);
+    arg.set_name('s');
+    arg.set_long_name("max-sessions");
+    arg.set_description(max_sessions_description);
+    arg.set_has_value(true);
+  }
+
+  // Parallel commands.
+  {
+    misc::argument& arg(_arguments['P']);
+    arg.set_name('P');
+    arg.set_long_name("parallel-commands");
+    arg.set_description(parallel_commands_description);
+  }
+
+  // Persistent shell.
+  {
+    misc::argument& arg(_arguments['S']);
+    arg.set_name('S');
+    arg.set_long_name("persistent-shell");
+    arg.set_description(persistent_shell_description);
+  }
+
+  // State file.
+  {
+    misc::argument& arg(_arguments['f']);
+    arg.set_name('f');
+    arg.set_long_name("state-file");
+    arg.set_description(state_file_description);
+    arg.set_has_value(true);
+  }
+
+  // Workers.
+  {
+    misc::argument& arg(_arguments['w']);
+    arg.set_name('w');
+    arg.set_long_name("workers");
+    arg.set_description(workers_description);
+    arg.set_has_value(true);
+  }
+
   return ;
 }
@@ -24,6 +24,7 @@
 #  include <pwd.h>
 #  include <unistd.h>
 #endif // Windows or POSIX.
+#include <cctype>
 #include <cstdlib>
 #include <getopt.h>
 #include "com/centreon/exceptions/basic.hh"
@@ -60,6 +61,33 @@ static struct option optlong[] = {
   { NULL,             no_argument,       NULL, 0   }
 };
 
+// SSH options (-o) that can be set on a check.
+static char const* const ssh_options[] = {
+  "Ciphers",
+  "Compression",
+  "HostKeyAlgorithms",
+  "KexAlgorithms",
+  "MACs",
+  "ProxyJump",
+  NULL
+};
+
+/**
+ *  Convert a string to lower case.
+ *
+ *  @param[in] str String.
+ *
+ *  @return Lower case string.
+ */
+static std::string to_lower(std::string const& str) {
+  std::string retval(str);
+  for (std::string::iterator it(retval.begin()), end(retval.end());
+       it != end;
+       ++it)
+    *it = tolower(static_cast<unsigned char>(*it));
+  return (retval);
+}
+
 /**************************************
 *                                     *
 *           Public Methods            *
@@ -162,6 +190,17 @@ unsigned short options::get_port() const throw () {
   return (_port);
 }
 
+/**
+ *  Get SSH options.
+ *
+ *  @return SSH options indexed by their name (Ciphers, Compression,
+ *          HostKeyAlgorithms, KexAlgorithms, MACs or ProxyJump).
+ */
+std::map<std::string, std::string> const&
+  options::get_ssh_options() const throw () {
+  return (_ssh_options);
+}
+
 /**
  *  Get timeout connection.
  *
@@ -201,7 +240,9 @@ std::string options::help() {
     "  -i, --identity:       Identity of an authorized key.\n"          \
     "  -l, --logname:        SSH user name on remote host.\n"           \
     "  -n, --name:           This option is not supported.\n"           \
-    "  -o, --ssh-option:     This option is not supported.\n"           \
+    "  -o, --ssh-option:     SSH option (Ciphers, Compression,\n"      \
+    "                        HostKeyAlgorithms, KexAlgorithms, MACs or\n" \
+    "                        ProxyJump).\n"                             \
     "  -O, --output:         This option is not supported.\n"           \
     "  -p, --port:           Port number (default: 22).\n"              \
     "  -q, --quiet:          Not used.\n"                               \
@@ -285,8 +326,7 @@ void options::parse(std::string const& cmdline) {
       break;
 
     case 'o': // Set ssh-option.
-      throw (basic_error() << "'" << c
-             << "' option is not supported");
+      _add_ssh_option(optarg);
       break;
 
     case 'O': // Set output file.
@@ -350,6 +390,52 @@ int options::skip_stdout() const throw () {
 *                                     *
 **************************************/
 
+/**
+ *  @brief Add a SSH option.
+ *
+ *  As with ssh, the option name and its value are separated by an
+ *  equal sign or whitespaces. Option names are case insensitive.
+ *
+ *  @param[in] opt Option.
+ */
+void options::_add_ssh_option(std::string const& opt) {
+  // Split name and value.
+  size_t name_end(opt.find_first_of("= \t"));
+  size_t value_pos((name_end == std::string::npos)
+                   ? std::string::npos
+                   : opt.find_first_not_of(" \t", name_end));
+  if ((value_pos != std::string::npos) && (opt[value_pos] == '='))
+    value_pos = opt.find_first_not_of(" \t", value_pos + 1);
+  if (value_pos == std::string::npos)
+    throw (basic_error() << "SSH option '" << opt
+           << "' has no value");
+  std::string name(to_lower(opt.substr(0, name_end)));
+  std::string value(opt.substr(value_pos));
+  if (value.find_first_of(" \t") != std::string::npos)
+    throw (basic_error() << "invalid value '" << value
+           << "' for SSH option '" << opt.substr(0, name_end) << "'");
+
+  // Find option.
+  char const* const* known(ssh_options);
+  while (*known && (to_lower(*known) != name))
+    ++known;
+  if (!*known)
+    throw (basic_error() << "SSH option '" << opt.substr(0, name_end)
+           << "' is not supported");
+  if (name == "compression") {
+    value = to_lower(value);
+    if ((value != "yes") && (value != "no"))
+      throw (basic_error() << "invalid value '" << value
+             << "' for SSH option 'Compression'");
+  }
+  else if ((name == "proxyjump")
+           && (value.find(',') != std::string::npos))
+    throw (basic_error() << "SSH option 'ProxyJump' only supports a "
+           "single jump host");
+  _ssh_options[*known] = value;
+  return ;
+}
+
 /**
  *  Copy internal data members.
  *
@@ -364,6 +450,7 @@ void options::_copy(options const& right) {
   _port = right._port;
   _skip_stderr = right._skip_stderr;
   _skip_stdout = right._skip_stdout;
+  _ssh_options = right._ssh_options;
   _timeout = right._timeout;
   _user = right._user;
 }
@@ -296,7 +296,8 @@ void parser::_parse(std::string const& cmd) {
           opt.get_commands(),
           opt.skip_stdout(),
           opt.skip_stderr(),
-          (opt.get_ip_protocol() == options::ip_v6));
+          (opt.get_ip_protocol() == options::ip_v6),
+          opt.get_ssh_options());
     }
     break ;
   case 4: // Quit query.
@@ -20,12 +20,11 @@
 #include <cstdlib>
 #include <memory>
 #include "com/centreon/concurrency/locker.hh"
-#include "com/centreon/connector/ssh/checks/check.hh"
 #include "com/centreon/connector/ssh/checks/result.hh"
 #include "com/centreon/connector/ssh/multiplexer.hh"
+#include "com/centreon/connector/ssh/options.hh"
 #include "com/centreon/connector/ssh/policy.hh"
-#include "com/centreon/connector/ssh/sessions/session.hh"
-#include "com/centreon/delayed_delete.hh"
+#include "com/centreon/connector/ssh/worker.hh"
 #include "com/centreon/logging/logger.hh"
 
 using namespace com::centreon::connector::ssh;
@@ -40,9 +39,58 @@ extern volatile bool should_exit;
 **************************************/
 
 /**
- *  Default constructor.
+ *  Constructor.
+ *
+ *  @param[in] opts Program options.
  */
-policy::policy() : _sin(stdin), _sout(stdout) {
+policy::policy(options const& opts)
+  : _coalesce(opts.get_coalesce_checks()),
+    _error(false),
+    _in_flight(0),
+    _sin(stdin),
+    _sout(stdout),
+    _state(opts.get_state_file()),
+    _threaded(opts.get_workers() > 0) {
+  // Create workers.
+  unsigned int count(_threaded ? opts.get_workers() : 1);
+  for (unsigned int i(0); i < count; ++i) {
+    std::auto_ptr<worker> w(new worker(opts, this));
+    if (!_state.get_path().empty())
+      w->set_state_file(&_state);
+    _workers.push_back(w.get());
+    w.release();
+  }
+
+  // Start worker threads.
+  if (_threaded) {
+    log_info(logging::low) << "starting " << count << " worker threads";
+    multiplexer::instance().handle_manager::add(&_wakeup, &_wakeup);
+    for (std::vector<worker*>::iterator
+           it(_workers.begin()), end(_workers.end());
+         it != end;
+         ++it)
+      (*it)->start();
+  }
+
+  // Connect sessions saved on last exit.
+  if (!_state.get_path().empty()) {
+    std::list<sessions::credentials> saved;
+    try {
+      _state.read(saved);
+    }
+    catch (std::exception const& e) {
+      log_error(logging::low) << e.what();
+    }
+    if (!saved.empty())
+      log_info(logging::low) << "warm start of " << saved.size()
+        << " sessions from " << _state.get_path();
+    for (std::list<sessions::credentials>::const_iterator
+           it(saved.begin()), end(saved.end());
+         it != end;
+         ++it)
+      _worker_of(*it).connect(*it);
+  }
+
   // Send information back.
   multiplexer::instance().handle_manager::add(&_sout, &_reporter);
 
@@ -61,36 +109,33 @@ policy::~policy() throw () {
     // Remove from multiplexer.
     multiplexer::instance().handle_manager::remove(&_sin);
     multiplexer::instance().handle_manager::remove(&_sout);
+    if (_threaded)
+      multiplexer::instance().handle_manager::remove(
+        static_cast<handle*>(&_wakeup));
   }
   catch (...) {}
 
-  // Close checks.
-  for (std::map<
-         unsigned long long,
-         std::pair<checks::check*, sessions::session*> >::iterator
-         it = _checks.begin(),
-         end = _checks.end();
+  // Stop workers (this closes their checks and sessions).
+  for (std::vector<worker*>::iterator
+         it(_workers.begin()), end(_workers.end());
        it != end;
        ++it) {
     try {
-      it->second.first->unlisten(this);
+      (*it)->stop();
     }
     catch (...) {}
-    delete it->second.first;
+    delete *it;
   }
-  _checks.clear();
+  _workers.clear();
 
-  // Close sessions.
-  for (std::map<sessions::credentials, sessions::session*>::iterator
-         it = _sessions.begin(),
-         end = _sessions.end();
-       it != end;
-       ++it) {
+  // Save sessions for next start.
+  if (!_state.get_path().empty()) {
     try {
-      it->second->close();
+      _state.write();
+    }
+    catch (std::exception const& e) {
+      log_error(logging::low) << e.what();
     }
-    catch (...) {}
-    delete it->second;
   }
 }
 
@@ -115,7 +160,8 @@ void policy::on_error(unsigned long long cmd_id, char const* msg) {
     r.set_command_id(cmd_id);
     r.set_executed(false);
     r.set_error(msg);
-    on_result(r);
+    _reporter.send_result(r);
+    multiplexer::instance().handle_manager::update(&_sout);
   }
   else {
     log_info(logging::low)
@@ -140,6 +186,7 @@ void policy::on_error(unsigned long long cmd_id, char const* msg) {
  *  @param[in] skip_stdout Ignore all or first n output lines.
  *  @param[in] skip_stderr Ignore all or first n error lines.
  *  @param[in] use_ipv6    Version of ip protocol to use.
+ *  @param[in] ssh_options SSH transport options.
  */
 void policy::on_execute(
                unsigned long long cmd_id,
@@ -152,66 +199,32 @@ void policy::on_execute(
                std::list<std::string> const& cmds,
                int skip_stdout,
                int skip_stderr,
-               bool use_ipv6) {
-  try {
-    // Log message.
-    log_info(logging::medium) << "got request to execute check "
-      << cmd_id << " on session " << user << "@" << host
-      << " (timeout " << timeout << ", first command \""
-      << cmds.front() << "\")";
-
-    // Credentials.
-    sessions::credentials creds;
-    creds.set_host(host);
-    creds.set_user(user);
-    creds.set_password(password);
-    creds.set_port(port);
-    creds.set_key(key);
-
-    // Object lock.
-    concurrency::locker lock(&_mutex);
-
-    // Find session.
-    std::map<sessions::credentials, sessions::session*>::iterator it;
-    it = _sessions.find(creds);
-    if (it == _sessions.end()) {
-      log_info(logging::low) << "creating session for "
-        << user << "@" << host << ":" << port;
-      std::auto_ptr<sessions::session> sess(new sessions::session(creds));
-      sess->connect(use_ipv6);
-      _sessions[creds] = sess.get();
-      sess.release();
-      it = _sessions.find(creds);
-    }
+               bool use_ipv6,
+               std::map<std::string, std::string> const& ssh_options) {
+  // Log message.
+  log_info(logging::medium) << "got request to execute check "
+    << cmd_id << " on session " << user << "@" << host
+    << " (timeout " << timeout << ", first command \""
+    << cmds.front() << "\")";
 
-    // Create check object.
-    std::auto_ptr<checks::check> chk(new checks::check(
-                                                   skip_stdout,
-                                                   skip_stderr));
-    chk->listen(this);
-    _checks[cmd_id] = std::make_pair(chk.get(), it->second);
-    checks::check* chk_ptr(chk.release());
-
-    // Release lock and run copied pointer (we might be called in
-    // on_result() and mutex must be available).
-    lock.unlock();
-    chk_ptr->execute(*it->second, cmd_id, cmds, timeout);
-  }
-  catch (std::exception const& e) {
-    log_error(logging::low) << "could not launch check ID "
-      << cmd_id << " on host " << host << " because an error occurred: "
-      << e.what();
-    checks::result r;
-    r.set_command_id(cmd_id);
-    on_result(r);
-  }
-  catch (...) {
-    log_error(logging::low) << "could not launch check ID "
-      << cmd_id << " on host " << host << " because an error occurred";
-    checks::result r;
-    r.set_command_id(cmd_id);
-    on_result(r);
-  }
+  // Credentials.
+  sessions::credentials creds;
+  creds.set_host(host);
+  creds.set_user(user);
+  creds.set_password(password);
+  creds.set_port(port);
+  creds.set_key(key);
+  creds.set_ssh_options(ssh_options);
+
+  // Check.
+  checks::coalescer::key k;
+  k.cmds = cmds;
+  k.creds = creds;
+  k.skip_stderr = skip_stderr;
+  k.skip_stdout = skip_stdout;
+  k.use_ipv6 = use_ipv6;
+  ++_in_flight;
+  _dispatch(cmd_id, timeout, k);
 
   return ;
 }
@@ -229,79 +242,26 @@ void policy::on_quit() {
 }
 
 /**
- *  Check result has arrived.
+ *  @brief Check result has arrived.
+ *
+ *  This method might be called from worker threads.
  *
  *  @param[in] r Check result.
  */
 void policy::on_result(checks::result const& r) {
-  // Object lock.
-  concurrency::locker lock(&_mutex);
-
-  // Remove check from list.
-  std::map<unsigned long long, std::pair<checks::check*, sessions::session*> >::iterator chk;
-  chk = _checks.find(r.get_command_id());
-  if (chk == _checks.end())
-    log_error(logging::medium) << "got result of check "
-      << r.get_command_id() << " which is not registered";
-  else {
-    try {
-      chk->second.first->unlisten(this);
-      chk->second.second->unlisten(chk->second.first);
-    }
-    catch (...) {}
-    delete chk->second.first;
-    sessions::session* sess(chk->second.second);
-    _checks.erase(chk);
-
-    // Check session.
-    if (!sess->is_connected()) {
-      log_debug(logging::medium) << "session " << sess << " is not"
-           " connected, checking if any check working with it remains";
-      bool found(false);
-      for (std::map<unsigned long long, std::pair<checks::check*, sessions::session*> >::iterator
-             it = _checks.begin(),
-             end = _checks.end();
-           it != end;
-           ++it)
-        if (it->second.second == sess) {
-          found = true;
-          break;
-        }
-      if (!found) {
-        std::map<sessions::credentials, sessions::session*>::iterator
-          it, end;
-        for (it = _sessions.begin(), end = _sessions.end();
-             it != end;
-             ++it) {
-          if (it->second == sess)
-            break ;
-        }
-        if (it == end)
-          log_error(logging::high) << "session " << sess
-            << " was not found in policy list, deleting anyway";
-        else {
-          log_info(logging::high) << "session "
-           << it->first.get_user() << "@" << it->first.get_host()
-           << ":" << it->first.get_port()
-           << " that is not connected and has "
-              "no check running will be deleted";
-          _sessions.erase(it);
-        }
-        std::auto_ptr<delayed_delete<sessions::session> >
-          dd(new delayed_delete<sessions::session>(sess));
-        multiplexer::instance().task_manager::add(
-          dd.get(),
-          0,
-          true,
-          true);
-        dd.release();
-      }
+  if (_threaded) {
+    // Results will be reported by the main thread.
+    {
+      concurrency::locker lock(&_mutex);
+      _results.push_back(r);
     }
+    _wakeup.wake();
+  }
+  else {
+    // Send check result back to monitoring engine.
+    _send_result(r);
+    multiplexer::instance().handle_manager::update(&_sout);
   }
-
-  // Send check result back to monitoring engine.
-  _reporter.send_result(r);
-
   return ;
 }
 
@@ -313,6 +273,7 @@ void policy::on_version() {
   log_info(logging::medium)
     << "monitoring engine requested protocol version, sending 1.0";
   _reporter.send_version(1, 0);
+  multiplexer::instance().handle_manager::update(&_sout);
   return ;
 }
 
@@ -322,23 +283,29 @@ void policy::on_version() {
  *  @return false if program terminated prematurely.
  */
 bool policy::run() {
-  // No error occurred yet.
-  _error = false;
-
   // Run multiplexer.
   while (!should_exit) {
     log_debug(logging::high) << "multiplexing";
     multiplexer::instance().multiplex();
+    _report_results();
   }
 
   // Run as long as a check remains.
   log_info(logging::low) << "waiting for checks to terminate";
-  while (!_checks.empty()) {
+  while (_in_flight) {
     log_debug(logging::high)
-      << "multiplexing remaining checks (" << _checks.size() << ")";
+      << "multiplexing remaining checks (" << _in_flight << ")";
     multiplexer::instance().multiplex();
+    _report_results();
   }
 
+  // Stop workers.
+  for (std::vector<worker*>::iterator
+         it(_workers.begin()), end(_workers.end());
+       it != end;
+       ++it)
+    (*it)->stop();
+
   // Run as long as some data remains.
   log_info(logging::low)
     << "reporting last data to monitoring engine";
@@ -349,3 +316,145 @@ bool policy::run() {
 
   return (!_error);
 }
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Attach a check to an identical running check or dispatch it to the
+ *  worker owning its session.
+ *
+ *  @param[in] cmd_id  Command ID.
+ *  @param[in] timeout Absolute time at which the check times out.
+ *  @param[in] k       Check key.
+ */
+void policy::_dispatch(
+               unsigned long long cmd_id,
+               time_t timeout,
+               checks::coalescer::key const& k) {
+  // Attach to an identical check that will complete in time.
+  if (_coalesce && _coalescer.attach(cmd_id, k, timeout)) {
+    log_info(logging::medium) << "check " << cmd_id
+      << " will get the result of an identical running check";
+    return ;
+  }
+
+  // Dispatch check to the worker owning the session.
+  _worker_of(k.creds).execute(
+    cmd_id,
+    timeout,
+    k.creds,
+    k.cmds,
+    k.skip_stdout,
+    k.skip_stderr,
+    k.use_ipv6);
+  return ;
+}
+
+/**
+ *  Report results received from worker threads.
+ */
+void policy::_report_results() {
+  if (_threaded) {
+    std::list<checks::result> results;
+    {
+      concurrency::locker lock(&_mutex);
+      results.swap(_results);
+    }
+    for (std::list<checks::result>::const_iterator
+           it(results.begin()), end(results.end());
+         it != end;
+         ++it)
+      _send_result(*it);
+    if (!results.empty())
+      multiplexer::instance().handle_manager::update(&_sout);
+  }
+  return ;
+}
+
+/**
+ *  Send a check result and the copies of checks that were coalesced
+ *  with it.
+ *
+ *  @param[in] r Check result.
+ */
+void policy::_send_result(checks::result const& r) {
+  --_in_flight;
+  _reporter.send_result(r);
+  checks::coalescer::key k;
+  std::list<unsigned long long> copies;
+  std::multimap<time_t, unsigned long long> retries;
+  if (!_coalescer.detach(
+         r.get_command_id(),
+         r.get_executed(),
+         time(NULL),
+         k,
+         copies,
+         retries))
+    return ;
+  checks::result copy(r);
+  for (std::list<unsigned long long>::const_iterator
+         cmd_id(copies.begin()),
+         end(copies.end());
+       cmd_id != end;
+       ++cmd_id) {
+    copy.set_command_id(*cmd_id);
+    --_in_flight;
+    _reporter.send_result(copy);
+  }
+
+  // Checks that still have time left do not inherit a failure, the
+  // earliest of them becomes the check the others attach to.
+  for (std::multimap<time_t, unsigned long long>::const_iterator
+         it(retries.begin()),
+         end(retries.end());
+       it != end;
+       ++it) {
+    log_info(logging::medium) << "check " << it->second
+      << " is executed as the identical check it waited for failed";
+    _dispatch(it->second, it->first, k);
+  }
+  return ;
+}
+
+/**
+ *  Get the worker owning the sessions of some credentials.
+ *
+ *  @param[in] creds Session credentials.
+ *
+ *  @return Worker that must execute checks using these credentials.
+ */
+worker& policy::_worker_of(sessions::credentials const& creds) {
+  if (_workers.size() == 1)
+    return (*_workers.front());
+
+  // All checks of a session must run on the same worker. Hash the
+  // fields identifying the remote end. Sessions using a jump host run
+  // on the worker owning their bastion session.
+  unsigned long hash(5381);
+  std::map<std::string, std::string>::const_iterator
+    jump(creds.get_ssh_options().find("ProxyJump"));
+  if (jump != creds.get_ssh_options().end()) {
+    for (std::string::const_iterator
+           it(jump->second.begin()), end(jump->second.end());
+         it != end;
+         ++it)
+      hash = hash * 33 + static_cast<unsigned char>(*it);
+    return (*_workers[hash % _workers.size()]);
+  }
+  std::string const& host(creds.get_host());
+  for (std::string::const_iterator it(host.begin()), end(host.end());
+       it != end;
+       ++it)
+    hash = hash * 33 + static_cast<unsigned char>(*it);
+  std::string const& user(creds.get_user());
+  for (std::string::const_iterator it(user.begin()), end(user.end());
+       it != end;
+       ++it)
+    hash = hash * 33 + static_cast<unsigned char>(*it);
+  hash = hash * 33 + creds.get_port();
+  return (*_workers[hash % _workers.size()]);
+}
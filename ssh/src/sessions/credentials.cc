@@ -96,7 +96,8 @@ bool credentials::operator==(credentials const& c) const {
           && (_host == c._host)
           && (_key == c._key)
           && (_password == c._password)
-          && (_user == c._user));
+          && (_user == c._user)
+          && (_ssh_options == c._ssh_options));
 }
 
 /**
@@ -130,6 +131,8 @@ bool credentials::operator<(credentials const& c) const {
     retval = (_port < c._port);
   else if (_key != c._key)
     retval = (_key < c._key);
+  else if (_ssh_options != c._ssh_options)
+    retval = (_ssh_options < c._ssh_options);
   else
     retval = false;
   return (retval);
@@ -171,6 +174,16 @@ unsigned short credentials::get_port() const {
   return (_port);
 }
 
+/**
+ *  Get SSH options.
+ *
+ *  @return SSH options indexed by their name.
+ */
+std::map<std::string, std::string> const&
+  credentials::get_ssh_options() const {
+  return (_ssh_options);
+}
+
 /**
  *  Get the user.
  *
@@ -220,6 +233,17 @@ void credentials::set_port(unsigned short port) {
   return ;
 }
 
+/**
+ *  Set SSH options.
+ *
+ *  @param[in] opts New SSH options.
+ */
+void credentials::set_ssh_options(
+                    std::map<std::string, std::string> const& opts) {
+  _ssh_options = opts;
+  return ;
+}
+
 /**
  *  Set the user.
  *
@@ -246,6 +270,7 @@ void credentials::_copy(credentials const& c) {
   _key = c._key;
   _password = c._password;
   _port = c._port;
+  _ssh_options = c._ssh_options;
   _user = c._user;
   return ;
 }
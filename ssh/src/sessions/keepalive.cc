@@ -0,0 +1,108 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include "com/centreon/connector/ssh/sessions/keepalive.hh"
+#include "com/centreon/connector/ssh/sessions/session.hh"
+
+using namespace com::centreon::connector::ssh::sessions;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] sess Session that will send keepalive messages.
+ */
+keepalive::keepalive(session* sess) : _session(sess) {}
+
+/**
+ *  Copy constructor.
+ *
+ *  @param[in] k Object to copy.
+ */
+keepalive::keepalive(keepalive const& k) : com::centreon::task(k) {
+  _internal_copy(k);
+}
+
+/**
+ *  Destructor.
+ */
+keepalive::~keepalive() throw () {}
+
+/**
+ *  Assignment operator.
+ *
+ *  @param[in] k Object to copy.
+ *
+ *  @return This object.
+ */
+keepalive& keepalive::operator=(keepalive const& k) {
+  if (this != &k) {
+    com::centreon::task::operator=(k);
+    _internal_copy(k);
+  }
+  return (*this);
+}
+
+/**
+ *  Get the session object.
+ *
+ *  @return Session object.
+ */
+session* keepalive::get_session() const throw () {
+  return (_session);
+}
+
+/**
+ *  Make session send a keepalive message.
+ */
+void keepalive::run() {
+  if (_session)
+    _session->on_keepalive();
+  return ;
+}
+
+/**
+ *  Set target session.
+ *
+ *  @param[in] sess Target session.
+ */
+void keepalive::set_session(session* sess) throw () {
+  _session = sess;
+  return ;
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Copy internal data members.
+ *
+ *  @param[in] k Object to copy.
+ */
+void keepalive::_internal_copy(keepalive const& k) {
+  _session = k._session;
+  return ;
+}
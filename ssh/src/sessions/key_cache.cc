@@ -0,0 +1,123 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#include "com/centreon/concurrency/locker.hh"
+#include "com/centreon/connector/ssh/sessions/key_cache.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::ssh::sessions;
+
+// Class instance pointer.
+static key_cache* _instance = NULL;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Destructor.
+ */
+key_cache::~key_cache() throw () {}
+
+/**
+ *  Get the content of a key file.
+ *
+ *  @param[in]  path File path.
+ *  @param[out] data File content.
+ */
+void key_cache::get(std::string const& path, std::string& data) {
+  struct stat st;
+  if (stat(path.c_str(), &st)) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not access key file '"
+           << path << "': " << msg);
+  }
+
+  concurrency::locker lock(&_mutex);
+  std::map<std::string, entry>::iterator it(_entries.find(path));
+  if ((it == _entries.end())
+      || (it->second.mtime != st.st_mtime)
+      || (it->second.size != st.st_size)) {
+    log_debug(logging::medium) << "loading key file " << path;
+    std::ifstream ifs(path.c_str(), std::ios::in | std::ios::binary);
+    if (!ifs.good())
+      throw (basic_error() << "could not open key file '"
+             << path << "'");
+    entry e;
+    e.data.assign(
+      std::istreambuf_iterator<char>(ifs),
+      std::istreambuf_iterator<char>());
+    if (ifs.bad())
+      throw (basic_error() << "could not read key file '"
+             << path << "'");
+    e.mtime = st.st_mtime;
+    e.size = st.st_size;
+    _entries[path] = e;
+    data = e.data;
+  }
+  else
+    data = it->second.data;
+  return ;
+}
+
+/**
+ *  Get class instance.
+ *
+ *  @return Key cache instance.
+ */
+key_cache& key_cache::instance() throw () {
+  return (*_instance);
+}
+
+/**
+ *  Load singleton.
+ */
+void key_cache::load() {
+  if (!_instance)
+    _instance = new key_cache;
+  return ;
+}
+
+/**
+ *  Unload singleton.
+ */
+void key_cache::unload() {
+  delete _instance;
+  _instance = NULL;
+  return ;
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Default constructor.
+ */
+key_cache::key_cache() {}
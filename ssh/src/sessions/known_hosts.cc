@@ -0,0 +1,205 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include "com/centreon/concurrency/locker.hh"
+#include "com/centreon/connector/ssh/sessions/known_hosts.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::ssh::sessions;
+
+// Class instance pointer.
+static known_hosts* _instance = NULL;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Destructor.
+ */
+known_hosts::~known_hosts() throw () {
+  _clear();
+  if (_session)
+    libssh2_session_free(_session);
+}
+
+/**
+ *  Check a host key against the known_hosts file.
+ *
+ *  @param[in] file Path to the known_hosts file.
+ *  @param[in] host Host name.
+ *  @param[in] key  Raw host key.
+ *  @param[in] len  Key length.
+ *
+ *  @return One of LIBSSH2_KNOWNHOST_CHECK_* values.
+ */
+int known_hosts::check(
+                   std::string const& file,
+                   std::string const& host,
+                   char const* key,
+                   size_t len) {
+  concurrency::locker lock(&_mutex);
+  _reload(file);
+
+  // Look for a previous result.
+  std::string id(host);
+  id.push_back('\0');
+  id.append(key, len);
+  std::map<std::string, int>::const_iterator it(_results.find(id));
+  if (it != _results.end())
+    return (it->second);
+
+  // Check host key.
+  libssh2_knownhost* kh;
+#if LIBSSH2_VERSION_NUM >= 0x010206
+  // Introduced in 1.2.6.
+  int retval(libssh2_knownhost_checkp(
+               _hosts,
+               host.c_str(),
+               -1,
+               key,
+               len,
+               LIBSSH2_KNOWNHOST_TYPE_PLAIN
+               | LIBSSH2_KNOWNHOST_KEYENC_RAW,
+               &kh));
+#else
+  // 1.2.5 or older.
+  int retval(libssh2_knownhost_check(
+               _hosts,
+               host.c_str(),
+               key,
+               len,
+               LIBSSH2_KNOWNHOST_TYPE_PLAIN
+               | LIBSSH2_KNOWNHOST_KEYENC_RAW,
+               &kh));
+#endif // LIBSSH2_VERSION_NUM
+  if (retval != LIBSSH2_KNOWNHOST_CHECK_FAILURE)
+    _results[id] = retval;
+  return (retval);
+}
+
+/**
+ *  Get class instance.
+ *
+ *  @return known_hosts instance.
+ */
+known_hosts& known_hosts::instance() throw () {
+  return (*_instance);
+}
+
+/**
+ *  Load singleton.
+ */
+void known_hosts::load() {
+  if (!_instance)
+    _instance = new known_hosts;
+  return ;
+}
+
+/**
+ *  Unload singleton.
+ */
+void known_hosts::unload() {
+  delete _instance;
+  _instance = NULL;
+  return ;
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Default constructor.
+ */
+known_hosts::known_hosts()
+  : _hosts(NULL), _mtime(0), _session(NULL), _size(0) {}
+
+/**
+ *  Release parsed hosts and remembered results.
+ */
+void known_hosts::_clear() throw () {
+  if (_hosts) {
+    libssh2_knownhost_free(_hosts);
+    _hosts = NULL;
+  }
+  _results.clear();
+  return ;
+}
+
+/**
+ *  Parse known_hosts file if it was not already or if it changed.
+ *
+ *  @param[in] file Path to the known_hosts file.
+ */
+void known_hosts::_reload(std::string const& file) {
+  struct stat st;
+  if (stat(file.c_str(), &st)) {
+    memset(&st, 0, sizeof(st));
+    log_debug(logging::medium) << "could not access known_hosts file "
+      << file << ": " << strerror(errno);
+  }
+  if (_hosts
+      && (file == _file)
+      && (st.st_mtime == _mtime)
+      && (st.st_size == _size))
+    return ;
+
+  // Known hosts lists are attached to a session. This one is only
+  // used to parse and check hosts.
+  _clear();
+  if (!_session) {
+    _session = libssh2_session_init();
+    if (!_session)
+      throw (basic_error()
+             << "could not create known hosts list (out of memory ?)");
+  }
+  _hosts = libssh2_knownhost_init(_session);
+  if (!_hosts) {
+    char* msg;
+    libssh2_session_last_error(_session, &msg, NULL, 0);
+    throw (basic_error()
+             << "could not create known hosts list: " << msg);
+  }
+
+  // Read OpenSSH's known hosts file.
+  int rh(libssh2_knownhost_readfile(
+           _hosts,
+           file.c_str(),
+           LIBSSH2_KNOWNHOST_FILE_OPENSSH));
+  if (rh < 0) {
+    _clear();
+    throw (basic_error() << "parsing of known_hosts file "
+             << file << " failed: error " << -rh);
+  }
+  log_info(logging::medium) << rh
+    << " hosts found in known_hosts file " << file;
+  _file = file;
+  _mtime = st.st_mtime;
+  _size = st.st_size;
+  return ;
+}
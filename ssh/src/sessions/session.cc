@@ -16,6 +16,7 @@
 ** For more information : contact@centreon.com
 */
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cerrno>
 #include <cstdlib>
@@ -25,17 +26,36 @@
 #include <memory>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <pwd.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include "com/centreon/concurrency/locker.hh"
+#include "com/centreon/connector/ssh/dns/resolver.hh"
 #include "com/centreon/connector/ssh/multiplexer.hh"
+#include "com/centreon/connector/ssh/sessions/keepalive.hh"
+#include "com/centreon/connector/ssh/sessions/key_cache.hh"
+#include "com/centreon/connector/ssh/sessions/known_hosts.hh"
 #include "com/centreon/connector/ssh/sessions/session.hh"
+#include "com/centreon/connector/ssh/sessions/shell.hh"
+#include "com/centreon/connector/ssh/sessions/timeout.hh"
+#include "com/centreon/connector/ssh/sessions/tunnel.hh"
 #include "com/centreon/exceptions/basic.hh"
 #include "com/centreon/logging/logger.hh"
+#include "com/centreon/timestamp.hh"
 
 using namespace com::centreon;
 using namespace com::centreon::connector::ssh::sessions;
 
+// Number of seconds a channel has to close before it is freed anyway.
+static time_t const channel_close_timeout(30);
+
+// Authentication method that last succeeded, per credentials. It is
+// shared by all worker threads.
+std::map<credentials, session::e_step> session::_auth_methods;
+concurrency::mutex                     session::_auth_methods_mutex;
+
 /**************************************
 *                                     *
 *           Public Methods            *
@@ -48,16 +68,37 @@ using namespace com::centreon::connector::ssh::sessions;
  *  @param[in] creds Connection credentials.
  */
 session::session(credentials const& creds)
-  : _creds(creds),
+  : _bastion(NULL),
+    _connect_timeout(0),
+    _creds(creds),
+    _keepalive(0),
+    _keepalive_count(0),
+    _keepalive_interval(0),
+    _last_read(0),
+    _lookup(NULL),
+    _max_channels(10),
     _needed_new_chan(false),
     _session(NULL),
+    _shell(NULL),
+    _shell_enabled(false),
     _step(session_startup),
-    _step_string("startup") {
+    _step_string("startup"),
+    _timeout(0),
+    _tunnel(NULL) {
   // Create session instance.
   _session = libssh2_session_init();
   if (!_session)
     throw (basic_error()
              << "SSH session creation failed (out of memory ?)");
+
+  // Transport preferences must be set before the handshake.
+  try {
+    _set_preferences();
+  }
+  catch (...) {
+    libssh2_session_free(_session);
+    throw ;
+  }
 }
 
 /**
@@ -69,6 +110,17 @@ session::~session() throw () {
   }
   catch (...) {}
 
+  // Delete persistent shell.
+  delete _shell;
+
+  // Free channels that were still closing.
+  for (std::list<closing_channel>::iterator
+         it(_closing.begin()), end(_closing.end());
+       it != end;
+       ++it)
+    libssh2_channel_free(it->channel);
+  _closing.clear();
+
   // Delete session.
   libssh2_session_set_blocking(_session, 1);
   libssh2_session_disconnect(
@@ -77,10 +129,62 @@ session::~session() throw () {
   libssh2_session_free(_session);
 }
 
+/**
+ *  @brief Reserve a channel slot.
+ *
+ *  A listener must own a slot before opening a channel. If the
+ *  session already has the maximum number of channels, the listener
+ *  is queued and will get a slot when a channel is released. Queued
+ *  listeners are served by earliest deadline first.
+ *
+ *  @param[in] listnr   Listener requesting a channel.
+ *  @param[in] deadline Time at which the listener will give up, 0 if
+ *                      it should be served first.
+ *
+ *  @return true if the listener owns a slot.
+ */
+bool session::acquire_channel(
+                sessions::listener* listnr,
+                time_t deadline) {
+  if (_channels.find(listnr) != _channels.end())
+    return (true);
+  if (_waiting.empty() && (_channels.size() < _max_channels)) {
+    _channels.insert(listnr);
+    return (true);
+  }
+  std::list<std::pair<time_t, sessions::listener*> >::iterator
+    it(_waiting.begin()), end(_waiting.end());
+  while ((it != end) && (it->second != listnr))
+    ++it;
+  if (it == end) {
+    log_debug(logging::medium) << "session "
+      << _creds.get_user() << "@" << _creds.get_host()
+      << ":" << _creds.get_port() << " has " << _channels.size()
+      << " channels open, listener " << listnr << " is queued";
+
+    // Listeners with the same deadline keep their arrival order.
+    it = _waiting.begin();
+    while ((it != end) && (it->first <= deadline))
+      ++it;
+    _waiting.insert(it, std::make_pair(deadline, listnr));
+  }
+  return (false);
+}
+
 /**
  *  Close session.
  */
 void session::close() {
+  // Remove connection timeout and keepalive tasks.
+  _remove_task(_timeout);
+  _remove_task(_keepalive);
+
+  // Cancel pending name resolution.
+  if (_lookup) {
+    dns::resolver::instance().cancel(_lookup);
+    _lookup = NULL;
+  }
+
   // Unregister with multiplexer.
   multiplexer::instance().handle_manager::remove(&_socket);
   multiplexer::instance().handle_manager::remove(this);
@@ -89,23 +193,62 @@ void session::close() {
   {
     _listnrs_it = _listnrs.begin();
     while (_listnrs_it != _listnrs.end()) {
-      std::set<listener*>::iterator it(_listnrs_it++);
+      std::set<sessions::listener*>::iterator it(_listnrs_it++);
       (*it)->on_close(*this);
     }
   }
 
-  // Close socket.
+  // Free channels that were still closing, no reply will come.
+  for (std::list<closing_channel>::iterator
+         it(_closing.begin()), end(_closing.end());
+       it != end;
+       ++it)
+    libssh2_channel_free(it->channel);
+  _closing.clear();
+
+  // Close tunnel and socket.
+  delete _tunnel;
+  _tunnel = NULL;
   _socket.close();
+  _channels.clear();
+  _waiting.clear();
 
   return ;
 }
 
+/**
+ *  @brief Close and free a channel.
+ *
+ *  When the close request is received on the remote end, the SSH
+ *  server closes the pipes it opened with the target process. It then
+ *  waits for it to exit (more or less forced by SIGPIPE if process
+ *  writes). However if process does not write, the close would not
+ *  complete until it exits (which could be like forever). So channels
+ *  are closed as socket events occur and freed anyway after a while,
+ *  without ever blocking the event loop.
+ *
+ *  @param[in] chan Channel to close, owned by the session afterwards.
+ */
+void session::close_channel(LIBSSH2_CHANNEL* chan) {
+  closing_channel c;
+  c.channel = chan;
+  c.closed = false;
+  c.deadline = time(NULL) + channel_close_timeout;
+  _closing.push_back(c);
+  _reap_channels();
+  if (_socket.get_native_handle() != native_handle_null)
+    multiplexer::instance().handle_manager::update(&_socket);
+  return ;
+}
+
 /**
  *  Open session.
+ *
+ *  @param[in] use_ipv6 Connect using IPv6.
  */
 void session::connect(bool use_ipv6) {
   // Check that session wasn't already open.
-  if (is_connected()) {
+  if (is_connected() || _lookup) {
     log_info(logging::high)
       << "attempt to open already opened session";
     return ;
@@ -115,122 +258,77 @@ void session::connect(bool use_ipv6) {
   _step = session_startup;
   _step_string = "startup";
 
+  // Register connection timeout, it covers name resolution, TCP
+  // connection, handshake and authentication.
+  if (_connect_timeout) {
+    timestamp tmt(timestamp::now());
+    tmt.add_seconds(_connect_timeout);
+    std::auto_ptr<timeout> t(new timeout(this));
+    _timeout = multiplexer::instance().task_manager::add(
+                                         t.get(),
+                                         tmt,
+                                         false,
+                                         true);
+    t.release();
+  }
+
+  // The bastion resolves and connects to the host.
+  if (_bastion) {
+    _connect_tunnel();
+    return ;
+  }
+
   char const* host_ptr(_creds.get_host().c_str());
-  unsigned short port(_creds.get_port());
+  int family(use_ipv6 ? AF_INET6 : AF_INET);
 
   // Host lookup.
   log_info(logging::high) << "looking up address " << host_ptr;
+  sockaddr_storage addr;
+  socklen_t addrlen;
+  memset(&addr, 0, sizeof(addr));
   int ret;
-  int sin_size;
-  std::auto_ptr<sockaddr> sin;
   if (use_ipv6) {
-    sockaddr_in6* sin6(new sockaddr_in6);
-    sin = std::auto_ptr<sockaddr>((sockaddr*)(sin6));
-    sin_size = sizeof(*sin6);
-    memset(sin6, 0, sin_size);
-
-    // Set address info.
+    sockaddr_in6* sin6((sockaddr_in6*)&addr);
     sin6->sin6_family = AF_INET6;
-    sin6->sin6_port = htons(port);
+    addrlen = sizeof(*sin6);
 
     // Try to avoid DNS lookup.
     ret = inet_pton(AF_INET6, host_ptr, &sin6->sin6_addr);
   }
   else {
-    sockaddr_in* sin4(new sockaddr_in);
-    sin = std::auto_ptr<sockaddr>((sockaddr*)(sin4));
-    sin_size = sizeof(*sin4);
-    memset(sin4, 0, sin_size);
-
-    // Set address info.
+    sockaddr_in* sin4((sockaddr_in*)&addr);
     sin4->sin_family = AF_INET;
-    sin4->sin_port = htons(port);
+    addrlen = sizeof(*sin4);
 
     // Try to avoid DNS lookup.
     ret = inet_pton(AF_INET, host_ptr, &sin4->sin_addr);
   }
 
-  if (ret == 1)
+  if (ret == 1) {
     log_debug(logging::high) << "host "
       << host_ptr << " is an IP address";
-  // DNS lookup.
-  else {
-    addrinfo hint;
-    memset(&hint, 0, sizeof(hint));
-    hint.ai_family = (use_ipv6 ? AF_INET6 : AF_INET);
-    hint.ai_socktype = SOCK_STREAM;
-    addrinfo* res(NULL);
-    int retval(getaddrinfo(
-                 host_ptr,
-                 NULL,
-                 &hint,
-                 &res));
-    if (retval)
-      throw (basic_error() << "lookup of host '" << host_ptr
-             << "' failed: " << gai_strerror(retval));
-    else if (!res)
-      throw (basic_error() << "no IPv" << (use_ipv6 ? "6" : "4")
-             << " address found for host '" << host_ptr << "'");
-
-    // Log message.
-    log_debug(logging::low) << "found host " << host_ptr
-      << " address through name resolution";
-
-    // Get address.
-    if (use_ipv6)
-      ((sockaddr_in6*)sin.get())->sin6_addr
-        = ((sockaddr_in6*)(res->ai_addr))->sin6_addr;
-    else
-      ((sockaddr_in*)sin.get())->sin_addr.s_addr
-        = ((sockaddr_in*)(res->ai_addr))->sin_addr.s_addr;
-    // Free result.
-    freeaddrinfo(res);
+    _connect((sockaddr*)&addr, addrlen);
   }
-
-  // Create socket.
-  int mysocket;
-  mysocket = ::socket((use_ipv6 ? AF_INET6 : AF_INET), SOCK_STREAM, 0);
-  if (mysocket < 0) {
-    char const* msg(strerror(errno));
-    throw (basic_error() << "socket creation failed: " << msg);
-  }
-
-  // Set socket non-blocking.
-  int flags(fcntl(mysocket, F_GETFL));
-  if (flags < 0) {
-    char const* msg(strerror(errno));
-    ::close(mysocket);
-    throw (basic_error() << "could not get socket flags: " << msg);
-  }
-  flags |= O_NONBLOCK;
-  if (fcntl(mysocket, F_SETFL, flags) == -1) {
-    char const* msg(strerror(errno));
-    ::close(mysocket);
-    throw (basic_error()
-             << "could not make socket non blocking: " << msg);
+  // Cached DNS lookup.
+  else if (dns::resolver::instance().find(
+                                       _creds.get_host(),
+                                       family,
+                                       addr,
+                                       addrlen)) {
+    log_debug(logging::low) << "found host " << host_ptr
+      << " address in cache";
+    _connect((sockaddr*)&addr, addrlen);
   }
-
-  // Connect to remote host.
-  if ((::connect(mysocket, sin.get(), sin_size) != 0)
-      && (errno != EINPROGRESS)) {
-      char const* msg(strerror(errno));
-      ::close(mysocket);
-      throw (basic_error() << "could not connect to '"
-               << host_ptr << "': " << msg);
+  // Asynchronous DNS lookup.
+  else {
+    log_debug(logging::low) << "resolving host " << host_ptr
+      << " asynchronously";
+    _lookup = dns::resolver::instance().resolve(
+                                          _creds.get_host(),
+                                          family,
+                                          this);
   }
 
-  _socket.set_native_handle(mysocket);
-
-  // Register with multiplexer.
-  multiplexer::instance().handle_manager::add(&_socket, this, true);
-
-  // Launch the connection process.
-  log_debug(logging::medium)
-    << "manually launching the connection process of session "
-    << _creds.get_user() << "@" << _creds.get_host()
-    << ":" << _creds.get_port();
-  _startup();
-
   return ;
 }
 
@@ -259,10 +357,21 @@ void session::error(handle& h) {
     << "error detected on socket, shutting down session "
     << _creds.get_user() << "@" << _creds.get_host()
     << ":" << _creds.get_port();
+  error();
   this->close();
   return ;
 }
 
+/**
+ *  Get the bastion session.
+ *
+ *  @return Session through which this session connects, NULL if it
+ *          connects directly to its host.
+ */
+session* session::get_bastion() const throw () {
+  return (_bastion);
+}
+
 /**
  *  Get the session credentials.
  *
@@ -281,6 +390,18 @@ LIBSSH2_SESSION* session::get_libssh2_session() const throw () {
   return (_session);
 }
 
+/**
+ *  Get the persistent shell of the session.
+ *
+ *  @return Persistent shell, NULL if commands should be executed on
+ *          their own channel.
+ */
+shell* session::get_shell() {
+  if (_shell_enabled && !_shell)
+    _shell = new shell(*this);
+  return (_shell);
+}
+
 /**
  *  Get the socket handle.
  *
@@ -299,12 +420,34 @@ bool session::is_connected() const throw () {
   return (_step == session_keepalive);
 }
 
+/**
+ *  Check if session is being connected.
+ *
+ *  @return true if name resolution, TCP connection, handshake or
+ *          authentication is in progress.
+ */
+bool session::is_connecting() throw () {
+  return (!is_connected()
+          && !is_dead()
+          && (_lookup
+              || (_socket.get_native_handle() != native_handle_null)));
+}
+
+/**
+ *  Check if session is dead.
+ *
+ *  @return true if session encountered an I/O error.
+ */
+bool session::is_dead() const throw () {
+  return (_step == session_error);
+}
+
 /**
  *  Add listener to session.
  *
  *  @param[in] listnr New listener.
  */
-void session::listen(listener* listnr) {
+void session::listen(sessions::listener* listnr) {
   _listnrs.insert(listnr);
   return ;
 }
@@ -320,6 +463,7 @@ LIBSSH2_CHANNEL* session::new_channel() {
 
   // New channel flag.
   _needed_new_chan = true;
+  multiplexer::instance().handle_manager::update(&_socket);
 
   // Attempt to open channel.
   chan = libssh2_channel_open_session(_session);
@@ -343,6 +487,139 @@ LIBSSH2_CHANNEL* session::new_channel() {
   return (chan);
 }
 
+/**
+ *  Get a new channel connected to a remote host.
+ *
+ *  @param[in] host Host the remote end connects to.
+ *  @param[in] port Port the remote end connects to.
+ *
+ *  @return New channel if possible, NULL otherwise.
+ */
+LIBSSH2_CHANNEL* session::new_direct_channel(
+                            std::string const& host,
+                            unsigned short port) {
+  // New channel flag.
+  _needed_new_chan = true;
+  multiplexer::instance().handle_manager::update(&_socket);
+
+  // Attempt to open channel.
+  LIBSSH2_CHANNEL* chan(libssh2_channel_direct_tcpip(
+                          _session,
+                          host.c_str(),
+                          port));
+
+  // Channel creation failed, check that we can try again later.
+  if (!chan) {
+    char* msg;
+    int ret(libssh2_session_last_error(
+              _session,
+              &msg,
+              NULL,
+              0));
+    if (ret != LIBSSH2_ERROR_EAGAIN) {
+      if (ret == LIBSSH2_ERROR_SOCKET_SEND)
+        error();
+      throw (basic_error() << "could not open tunnel to " << host
+             << ":" << port << ": " << msg);
+    }
+  }
+  return (chan);
+}
+
+/**
+ *  Send a keepalive message.
+ */
+void session::on_keepalive() {
+  // Task is deleted by the task manager.
+  _keepalive = 0;
+  if (!is_connected())
+    return ;
+
+  // The kernel cannot see the keepalive replies of tunneled sessions,
+  // the peer is dead if nothing was read for count intervals.
+  if (_tunnel
+      && _keepalive_count
+      && (time(NULL) - _last_read
+          >= static_cast<time_t>(_keepalive_interval * _keepalive_count))) {
+    log_error(logging::medium) << "session " << _creds.get_user()
+      << "@" << _creds.get_host() << ":" << _creds.get_port()
+      << " did not acknowledge " << _keepalive_count
+      << " keepalives, shutting it down";
+    error();
+    this->close();
+    return ;
+  }
+
+  int next(0);
+  int ret(libssh2_keepalive_send(_session, &next));
+  if (ret && (ret != LIBSSH2_ERROR_EAGAIN)) {
+    log_error(logging::medium) << "could not send keepalive on "
+      "session " << _creds.get_user() << "@" << _creds.get_host()
+      << ":" << _creds.get_port() << ", shutting it down";
+    error();
+    this->close();
+    return ;
+  }
+  log_debug(logging::high) << "keepalive sent on session "
+    << _creds.get_user() << "@" << _creds.get_host()
+    << ":" << _creds.get_port();
+  multiplexer::instance().handle_manager::update(&_socket);
+  _schedule_keepalive((next > 0) ? next : _keepalive_interval);
+  return ;
+}
+
+/**
+ *  Host name resolution failed.
+ *
+ *  @param[in] msg Error message.
+ */
+void session::on_resolve_error(std::string const& msg) {
+  _lookup = NULL;
+  log_error(logging::medium) << "session "
+    << _creds.get_user() << "@" << _creds.get_host()
+    << ":" << _creds.get_port() << " could not connect: " << msg;
+  this->close();
+  return ;
+}
+
+/**
+ *  Host name was resolved, connect to remote host.
+ *
+ *  @param[in] addr    Remote address.
+ *  @param[in] addrlen Address length.
+ */
+void session::on_resolved(sockaddr const* addr, socklen_t addrlen) {
+  _lookup = NULL;
+  try {
+    sockaddr_storage remote;
+    memcpy(&remote, addr, addrlen);
+    _connect((sockaddr*)&remote, addrlen);
+  }
+  catch (std::exception const& e) {
+    log_error(logging::medium) << "session "
+      << _creds.get_user() << "@" << _creds.get_host()
+      << ":" << _creds.get_port()
+      << " encountered an error: " << e.what();
+    this->close();
+  }
+  return ;
+}
+
+/**
+ *  Session could not connect within the connect timeout.
+ */
+void session::on_timeout() {
+  // Task is deleted by the task manager.
+  _timeout = 0;
+
+  log_error(logging::medium) << "session "
+    << _creds.get_user() << "@" << _creds.get_host()
+    << ":" << _creds.get_port() << " could not connect within "
+    << _connect_timeout << " seconds (step " << _step_string << ")";
+  this->close();
+  return ;
+}
+
 /**
  *  Read data is available.
  *
@@ -350,8 +627,14 @@ LIBSSH2_CHANNEL* session::new_channel() {
  */
 void session::read(handle& h) {
   (void)h;
+  // Also called on write, only data from the peer proves it is alive.
+  int pending(0);
+  if (!ioctl(_socket.get_native_handle(), FIONREAD, &pending)
+      && (pending > 0))
+    _last_read = time(NULL);
   static void (session::* const redirector[])() = {
       &session::_startup,
+      &session::_auth_list,
       &session::_passwd,
       &session::_key,
       &session::_available
@@ -369,14 +652,109 @@ void session::read(handle& h) {
   return ;
 }
 
+/**
+ *  @brief Release the channel slot of a listener.
+ *
+ *  Queued listeners get the freed slots by earliest deadline and will
+ *  open their channel on next session availability.
+ *
+ *  @param[in] listnr Listener releasing its channel.
+ */
+void session::release_channel(sessions::listener* listnr) {
+  if (!_channels.erase(listnr)) {
+    for (std::list<std::pair<time_t, sessions::listener*> >::iterator
+           it(_waiting.begin()), end(_waiting.end());
+         it != end;
+         ++it)
+      if (it->second == listnr) {
+        _waiting.erase(it);
+        break ;
+      }
+    return ;
+  }
+  bool promoted(false);
+  while (!_waiting.empty() && (_channels.size() < _max_channels)) {
+    _channels.insert(_waiting.front().second);
+    _waiting.pop_front();
+    promoted = true;
+  }
+  if (promoted
+      && (_socket.get_native_handle() != native_handle_null)) {
+    // Make session available again to start queued listeners.
+    _needed_new_chan = true;
+    multiplexer::instance().handle_manager::update(&_socket);
+  }
+  return ;
+}
+
+/**
+ *  @brief Set the bastion session.
+ *
+ *  The bastion must outlive this session.
+ *
+ *  @param[in] bastion Session through which this session connects,
+ *                     NULL to connect directly.
+ */
+void session::set_bastion(session* bastion) throw () {
+  _bastion = bastion;
+  return ;
+}
+
+/**
+ *  Set the connect timeout.
+ *
+ *  @param[in] secs Number of seconds allowed to connect and
+ *                  authenticate, 0 to disable.
+ */
+void session::set_connect_timeout(unsigned int secs) {
+  _connect_timeout = secs;
+  return ;
+}
+
+/**
+ *  Set keepalive parameters.
+ *
+ *  @param[in] interval Number of seconds between keepalive messages,
+ *                      0 to disable.
+ *  @param[in] count    Number of unacknowledged keepalive messages
+ *                      after which the session is dead, 0 to let the
+ *                      system decide.
+ */
+void session::set_keepalive(unsigned int interval, unsigned int count) {
+  _keepalive_count = count;
+  _keepalive_interval = interval;
+  return ;
+}
+
+/**
+ *  Set the maximum number of channels opened simultaneously.
+ *
+ *  @param[in] max Maximum number of channels.
+ */
+void session::set_max_channels(unsigned int max) {
+  _max_channels = max;
+  return ;
+}
+
+/**
+ *  Enable or disable the persistent shell.
+ *
+ *  @param[in] enable true to run commands in a persistent shell.
+ */
+void session::set_persistent_shell(bool enable) {
+  _shell_enabled = enable;
+  return ;
+}
+
 /**
  *  Remove a listener.
  *
  *  @param[in] listnr Listener to remove.
  */
-void session::unlisten(listener* listnr) {
+void session::unlisten(sessions::listener* listnr) {
+  release_channel(listnr);
   unsigned int size(_listnrs.size());
-  std::set<listener*>::iterator it(_listnrs.find(listnr));
+  std::set<sessions::listener*>::iterator it(_listnrs.find(listnr));
   if (it != _listnrs.end()) {
     if (_listnrs_it == it)
       ++_listnrs_it;
@@ -438,20 +816,232 @@ void session::write(handle& h) {
 *                                     *
 **************************************/
 
+/**
+ *  Query authentication methods supported by the server.
+ */
+void session::_auth_list() {
+  // Log message.
+  log_info(logging::medium)
+    << "querying authentication methods of session "
+    << _creds.get_user() << "@" << _creds.get_host()
+    << ":" << _creds.get_port();
+
+  char const* list(libssh2_userauth_list(
+                     _session,
+                     _creds.get_user().c_str(),
+                     _creds.get_user().size()));
+  if (!list) {
+    // Server accepted "none" authentication.
+    if (libssh2_userauth_authenticated(_session)) {
+      log_info(logging::medium) << "session "
+        << _creds.get_user() << "@" << _creds.get_host()
+        << ":" << _creds.get_port()
+        << " does not require authentication";
+      _connected();
+    }
+    else {
+      char* msg;
+      int ret(libssh2_session_last_error(_session, &msg, NULL, 0));
+      if (ret != LIBSSH2_ERROR_EAGAIN)
+        throw (basic_error() << "could not get authentication methods: "
+               << msg << " (error " << ret << ")");
+    }
+    return ;
+  }
+
+  // Pick method.
+  std::string methods(",");
+  methods.append(list);
+  methods.append(",");
+  log_debug(logging::medium) << "session "
+    << _creds.get_user() << "@" << _creds.get_host()
+    << ":" << _creds.get_port()
+    << " supports authentication methods " << list;
+  if (methods.find(",password,") != std::string::npos) {
+    _step = session_password;
+    _step_string = "password authentication";
+    _passwd();
+  }
+  else if (methods.find(",publickey,") != std::string::npos) {
+    _step = session_key;
+    _step_string = "public key authentication";
+    _key();
+  }
+  else
+    throw (basic_error()
+           << "no supported authentication method (server offers "
+           << list << ")");
+  return ;
+}
+
 /**
  *  Session is available for operation.
  */
 void session::_available() {
+  _reap_channels();
   log_debug(logging::high) << "session " << this
     << " is available and has " << _listnrs.size() << " listeners";
   _listnrs_it = _listnrs.begin();
   while (_listnrs_it != _listnrs.end()) {
-    std::set<listener*>::iterator it(_listnrs_it++);
+    std::set<sessions::listener*>::iterator it(_listnrs_it++);
     (*it)->on_available(*this);
   }
   return ;
 }
 
+/**
+ *  Connect socket to remote host and launch the SSH handshake.
+ *
+ *  @param[in,out] addr    Remote address, port is set by this method.
+ *  @param[in]     addrlen Address length.
+ */
+void session::_connect(sockaddr* addr, socklen_t addrlen) {
+  char const* host_ptr(_creds.get_host().c_str());
+  unsigned short port(_creds.get_port());
+  if (addr->sa_family == AF_INET6)
+    ((sockaddr_in6*)addr)->sin6_port = htons(port);
+  else
+    ((sockaddr_in*)addr)->sin_port = htons(port);
+
+  // Create socket.
+  int mysocket;
+  mysocket = ::socket(addr->sa_family, SOCK_STREAM, 0);
+  if (mysocket < 0) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "socket creation failed: " << msg);
+  }
+
+  // Set socket non-blocking.
+  int flags(fcntl(mysocket, F_GETFL));
+  if (flags < 0) {
+    char const* msg(strerror(errno));
+    ::close(mysocket);
+    throw (basic_error() << "could not get socket flags: " << msg);
+  }
+  flags |= O_NONBLOCK;
+  if (fcntl(mysocket, F_SETFL, flags) == -1) {
+    char const* msg(strerror(errno));
+    ::close(mysocket);
+    throw (basic_error()
+             << "could not make socket non blocking: " << msg);
+  }
+
+  // Connect to remote host.
+  if ((::connect(mysocket, addr, addrlen) != 0)
+      && (errno != EINPROGRESS)) {
+      char const* msg(strerror(errno));
+      ::close(mysocket);
+      throw (basic_error() << "could not connect to '"
+               << host_ptr << "': " << msg);
+  }
+
+  _socket.set_native_handle(mysocket);
+
+  // Register with multiplexer.
+  multiplexer::instance().handle_manager::add(&_socket, this, true);
+
+  // Launch the connection process.
+  log_debug(logging::medium)
+    << "manually launching the connection process of session "
+    << _creds.get_user() << "@" << _creds.get_host()
+    << ":" << _creds.get_port();
+  _startup();
+
+  return ;
+}
+
+/**
+ *  Session is authenticated, notify listeners.
+ */
+void session::_connected() {
+  _remove_task(_timeout);
+  _step = session_keepalive;
+  _step_string = "keep-alive";
+  _last_read = time(NULL);
+
+  // Send keepalive messages. The kernel aborts the connection if they
+  // are not acknowledged after count intervals. Tunneled sessions do
+  // not own a TCP connection and are checked in on_keepalive().
+  if (_keepalive_interval) {
+    libssh2_keepalive_config(_session, 1, _keepalive_interval);
+#ifdef TCP_USER_TIMEOUT
+    if (_keepalive_count && !_tunnel) {
+      unsigned int ms(_keepalive_interval * _keepalive_count * 1000);
+      if (setsockopt(
+            _socket.get_native_handle(),
+            IPPROTO_TCP,
+            TCP_USER_TIMEOUT,
+            &ms,
+            sizeof(ms))) {
+        char const* msg(strerror(errno));
+        log_error(logging::medium) << "could not set TCP user timeout "
+          "of session " << _creds.get_user() << "@" << _creds.get_host()
+          << ":" << _creds.get_port() << ": " << msg;
+      }
+    }
+#endif // TCP_USER_TIMEOUT
+    _schedule_keepalive(_keepalive_interval);
+  }
+
+  _listnrs_it = _listnrs.begin();
+  while (_listnrs_it != _listnrs.end()) {
+    std::set<sessions::listener*>::iterator it(_listnrs_it++);
+    (*it)->on_connected(*this);
+  }
+  return ;
+}
+
+/**
+ *  Connect to remote host through a tunnel opened on the bastion
+ *  session and launch the SSH handshake.
+ */
+void session::_connect_tunnel() {
+  log_info(logging::high) << "connecting to "
+    << _creds.get_host() << ":" << _creds.get_port()
+    << " through session "
+    << _bastion->get_credentials().get_user() << "@"
+    << _bastion->get_credentials().get_host() << ":"
+    << _bastion->get_credentials().get_port();
+
+  // Local socket pair, the tunnel relays the other end.
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds)) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "socket pair creation failed: " << msg);
+  }
+  for (unsigned int i(0); i < 2; ++i) {
+    int flags(fcntl(fds[i], F_GETFL));
+    if ((flags < 0) || (fcntl(fds[i], F_SETFL, flags | O_NONBLOCK) < 0)) {
+      char const* msg(strerror(errno));
+      ::close(fds[0]);
+      ::close(fds[1]);
+      throw (basic_error()
+             << "could not make socket pair non blocking: " << msg);
+    }
+  }
+  _socket.set_native_handle(fds[0]);
+  try {
+    _tunnel = new tunnel(
+                    *_bastion,
+                    _creds.get_host(),
+                    _creds.get_port(),
+                    fds[1]);
+  }
+  catch (...) {
+    ::close(fds[1]);
+    _socket.close();
+    throw ;
+  }
+
+  // Register with multiplexer.
+  multiplexer::instance().handle_manager::add(&_socket, this, true);
+
+  // Launch the connection process, data is buffered until the tunnel
+  // is opened.
+  _startup();
+  return ;
+}
+
 /**
  *  Attempt public key authentication.
  */
@@ -484,15 +1074,54 @@ void session::_key() {
   }
 
   // Try public key authentication.
+#if LIBSSH2_VERSION_NUM >= 0x010600
+  // Key files are cached in memory (introduced in 1.6.0). Crypto
+  // backends that do not implement it fall back to key files below.
+  std::string priv_data;
+  std::string pub_data;
+  key_cache::instance().get(priv, priv_data);
+  try {
+    key_cache::instance().get(pub, pub_data);
+  }
+  catch (std::exception const& e) {
+    // Public key will be derived from private key.
+    log_debug(logging::medium) << e.what();
+  }
+  int retval(libssh2_userauth_publickey_frommemory(
+               _session,
+               _creds.get_user().c_str(),
+               _creds.get_user().size(),
+               pub_data.empty() ? NULL : pub_data.data(),
+               pub_data.size(),
+               priv_data.data(),
+               priv_data.size(),
+               _creds.get_password().c_str()));
+
+  // Crypto backend cannot load keys from memory, read key files.
+  if ((retval == LIBSSH2_ERROR_METHOD_NOT_SUPPORTED)
+      || (retval == LIBSSH2_ERROR_FILE)) {
+    log_debug(logging::medium) << "could not load key " << priv
+      << " from memory, reading key files";
+    retval = libssh2_userauth_publickey_fromfile(
+               _session,
+               _creds.get_user().c_str(),
+               pub.c_str(),
+               priv.c_str(),
+               _creds.get_password().c_str());
+  }
+#else
   int retval(libssh2_userauth_publickey_fromfile(
                _session,
                _creds.get_user().c_str(),
                pub.c_str(),
                priv.c_str(),
                _creds.get_password().c_str()));
+#endif // LIBSSH2_VERSION_NUM
   if (retval < 0) {
-    if (retval != LIBSSH2_ERROR_EAGAIN)
+    if (retval != LIBSSH2_ERROR_EAGAIN) {
+      _set_auth_method(session_startup);
       throw (basic_error() << "user authentication failed");
+    }
   }
   else {
     // Log message.
@@ -504,16 +1133,9 @@ void session::_key() {
     // Enable non-blocking mode.
     libssh2_session_set_blocking(_session, 0);
 
-    // Set execution step.
-    _step = session_keepalive;
-    _step_string = "keep-alive";
-    {
-      _listnrs_it = _listnrs.begin();
-      while (_listnrs_it != _listnrs.end()) {
-        std::set<listener*>::iterator it(_listnrs_it++);
-        (*it)->on_connected(*this);
-      }
-    }
+    // Remember method and set execution step.
+    _set_auth_method(session_key);
+    _connected();
   }
   return ;
 }
@@ -564,15 +1186,148 @@ void session::_passwd() {
       << ":" << _creds.get_port();
 
     // We're now connected.
-    _step = session_keepalive;
-    _step_string = "keep-alive";
-    {
-      _listnrs_it = _listnrs.begin();
-      while (_listnrs_it != _listnrs.end()) {
-        std::set<listener*>::iterator it(_listnrs_it++);
-        (*it)->on_connected(*this);
+    _set_auth_method(session_password);
+    _connected();
+  }
+  return ;
+}
+
+/**
+ *  Make progress on closing channels.
+ */
+void session::_reap_channels() {
+  time_t now(time(NULL));
+  std::list<closing_channel>::iterator it(_closing.begin());
+  while (it != _closing.end()) {
+    // Wait for the remote end to acknowledge close.
+    if (!it->closed) {
+      int ret(libssh2_channel_close(it->channel));
+      if (ret == LIBSSH2_ERROR_EAGAIN) {
+        if (now < it->deadline) {
+          ++it;
+          continue ;
+        }
+        log_info(logging::medium) << "channel " << it->channel
+          << " of session " << _creds.get_user() << "@"
+          << _creds.get_host() << ":" << _creds.get_port()
+          << " did not close within " << channel_close_timeout
+          << " seconds, freeing it";
       }
+      it->closed = true;
+    }
+
+    // Free channel.
+    if (libssh2_channel_free(it->channel) == LIBSSH2_ERROR_EAGAIN)
+      ++it;
+    else
+      it = _closing.erase(it);
+  }
+  return ;
+}
+
+/**
+ *  Remove a task from the task manager.
+ *
+ *  @param[in,out] id Task ID, reset to 0.
+ */
+void session::_remove_task(unsigned long& id) {
+  if (id) {
+    try {
+      multiplexer::instance().task_manager::remove(id);
     }
+    catch (...) {}
+    id = 0;
+  }
+  return ;
+}
+
+/**
+ *  Schedule next keepalive message.
+ *
+ *  @param[in] delay Number of seconds until next message.
+ */
+void session::_schedule_keepalive(unsigned int delay) {
+  _remove_task(_keepalive);
+  timestamp when(timestamp::now());
+  when.add_seconds(delay);
+  std::auto_ptr<keepalive> k(new keepalive(this));
+  _keepalive = multiplexer::instance().task_manager::add(
+                                          k.get(),
+                                          when,
+                                          false,
+                                          true);
+  k.release();
+  return ;
+}
+
+/**
+ *  Remember the authentication method of these credentials.
+ *
+ *  @param[in] method session_password, session_key or session_startup
+ *                    to forget method.
+ */
+void session::_set_auth_method(e_step method) {
+  concurrency::locker lock(&_auth_methods_mutex);
+  if (method == session_startup)
+    _auth_methods.erase(_creds);
+  else
+    _auth_methods[_creds] = method;
+  return ;
+}
+
+/**
+ *  Set transport preferences from the SSH options of the credentials.
+ */
+void session::_set_preferences() {
+  std::map<std::string, std::string> const&
+    opts(_creds.get_ssh_options());
+  for (std::map<std::string, std::string>::const_iterator
+         it(opts.begin()), end(opts.end());
+       it != end;
+       ++it) {
+    if (it->first == "Compression") {
+      bool enable(it->second == "yes");
+#ifdef LIBSSH2_FLAG_COMPRESS
+      libssh2_session_flag(_session, LIBSSH2_FLAG_COMPRESS, enable);
+#else
+      if (enable)
+        throw (basic_error()
+               << "SSH compression is not supported by libssh2");
+#endif // LIBSSH2_FLAG_COMPRESS
+      continue ;
+    }
+
+    // Jump host is handled by the worker.
+    if (it->first == "ProxyJump")
+      continue ;
+
+    // Both directions use the same algorithms.
+    int methods[2];
+    if (it->first == "Ciphers") {
+      methods[0] = LIBSSH2_METHOD_CRYPT_CS;
+      methods[1] = LIBSSH2_METHOD_CRYPT_SC;
+    }
+    else if (it->first == "MACs") {
+      methods[0] = LIBSSH2_METHOD_MAC_CS;
+      methods[1] = LIBSSH2_METHOD_MAC_SC;
+    }
+    else if (it->first == "KexAlgorithms")
+      methods[0] = methods[1] = LIBSSH2_METHOD_KEX;
+    else if (it->first == "HostKeyAlgorithms")
+      methods[0] = methods[1] = LIBSSH2_METHOD_HOSTKEY;
+    else
+      throw (basic_error() << "SSH option '" << it->first
+             << "' is not supported");
+    for (unsigned int i(0); i < 2; ++i)
+      if (libssh2_session_method_pref(
+            _session,
+            methods[i],
+            it->second.c_str()) < 0) {
+        char* msg;
+        libssh2_session_last_error(_session, &msg, NULL, 0);
+        throw (basic_error() << "invalid value '" << it->second
+               << "' for SSH option '" << it->first << "': " << msg);
+      }
   }
   return ;
 }
@@ -616,35 +1371,16 @@ void session::_startup() {
       << ":" << _creds.get_port() << " successfully initialized";
 
 #ifdef WITH_KNOWN_HOSTS_CHECK
-    // Initialize known hosts list.
-    LIBSSH2_KNOWNHOSTS* known_hosts(libssh2_knownhost_init(_session));
-    if (!known_hosts) {
-      char* msg;
-      libssh2_session_last_error(_session, &msg, NULL, 0);
-      throw (basic_error()
-               << "could not create known hosts list: " << msg);
-    }
-
     // Get home directory.
     passwd* pw(getpwuid(getuid()));
 
-    // Read OpenSSH's known hosts file.
+    // OpenSSH's known hosts file.
     std::string known_hosts_file;
     if (pw && pw->pw_dir) {
       known_hosts_file = pw->pw_dir;
       known_hosts_file.append("/.ssh/");
     }
     known_hosts_file.append("known_hosts");
-    int rh(libssh2_knownhost_readfile(
-             known_hosts,
-             known_hosts_file.c_str(),
-             LIBSSH2_KNOWNHOST_FILE_OPENSSH));
-    if (rh < 0)
-      throw (basic_error() << "parsing of known_hosts file "
-               << known_hosts_file << " failed: error " << -rh);
-    else
-      log_info(logging::medium) << rh
-        << " hosts found in known_hosts file " << known_hosts_file;
 
     // Check host fingerprint against known hosts.
     log_info(logging::high) << "checking fingerprint on session "
@@ -661,38 +1397,16 @@ void session::_startup() {
     if (!fingerprint) {
       char* msg;
       libssh2_session_last_error(_session, &msg, NULL, 0);
-      libssh2_knownhost_free(known_hosts);
       throw (basic_error()
                << "failed to get remote host fingerprint: " << msg);
     }
 
-    // Check fingerprint.
-    libssh2_knownhost* kh;
-#if LIBSSH2_VERSION_NUM >= 0x010206
-    // Introduced in 1.2.6.
-    int check(libssh2_knownhost_checkp(
-                known_hosts,
-                _creds.get_host().c_str(),
-                -1,
-                fingerprint,
-                len,
-                LIBSSH2_KNOWNHOST_TYPE_PLAIN
-                | LIBSSH2_KNOWNHOST_KEYENC_RAW,
-                &kh));
-#else
-      // 1.2.5 or older.
-    int check(libssh2_knownhost_check(
-                known_hosts,
-                creds.get_host().c_str(),
-                fingerprint,
-                len,
-                LIBSSH2_KNOWNHOST_TYPE_PLAIN
-                | LIBSSH2_KNOWNHOST_KEYENC_RAW,
-                &kh));
-#endif // LIBSSH2_VERSION_NUM
-
-    // Free known hosts list.
-    libssh2_knownhost_free(known_hosts);
+    // Check fingerprint against shared known hosts list.
+    int check(known_hosts::instance().check(
+                                        known_hosts_file,
+                                        _creds.get_host(),
+                                        fingerprint,
+                                        len));
 
     // Check fingerprint.
     if (check != LIBSSH2_KNOWNHOST_CHECK_MATCH) {
@@ -714,10 +1428,30 @@ void session::_startup() {
       << ":" << _creds.get_port()
       << " matches a known host";
 #endif // WITH_KNOWN_HOSTS_CHECKS
-    // Successful peer authentication.
-    _step = session_password;
-    _step_string = "password authentication";
-    _passwd();
+    // Successful peer authentication. Use the authentication method
+    // that previously succeeded with these credentials if any.
+    e_step method;
+    {
+      concurrency::locker lock(&_auth_methods_mutex);
+      std::map<credentials, e_step>::const_iterator
+        it(_auth_methods.find(_creds));
+      method = ((it != _auth_methods.end()) ? it->second : session_startup);
+    }
+    if (method == session_password) {
+      _step = session_password;
+      _step_string = "password authentication";
+      _passwd();
+    }
+    else if (method == session_key) {
+      _step = session_key;
+      _step_string = "public key authentication";
+      _key();
+    }
+    else {
+      _step = session_auth_list;
+      _step_string = "authentication methods query";
+      _auth_list();
+    }
   }
   return ;
 }
@@ -0,0 +1,435 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+#include <unistd.h>
+#include "com/centreon/connector/ssh/multiplexer.hh"
+#include "com/centreon/connector/ssh/sessions/session.hh"
+#include "com/centreon/connector/ssh/sessions/shell.hh"
+#include "com/centreon/connector/ssh/sessions/shell_listener.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::ssh::sessions;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] sess Session on which the shell will be run.
+ */
+shell::shell(session& sess)
+  : _channel(NULL),
+    _processing(false),
+    _running(false),
+    _sequence(0),
+    _session(sess),
+    _step(shell_open) {
+  // Delimiters must not be guessed by remote commands.
+  unsigned char random[16];
+  size_t size(0);
+  FILE* f(fopen("/dev/urandom", "r"));
+  if (f) {
+    size = fread(random, 1, sizeof(random), f);
+    fclose(f);
+  }
+  std::ostringstream oss;
+  oss << "CCCS_" << std::hex;
+  if (size == sizeof(random))
+    for (unsigned int i(0); i < sizeof(random); ++i)
+      oss << (random[i] >> 4) << (random[i] & 0x0f);
+  else {
+    log_error(logging::medium)
+      << "could not read /dev/urandom, shell delimiters are weaker";
+    oss << time(NULL) << getpid() << this << rand();
+  }
+  oss << "_";
+  _token_prefix = oss.str();
+  _session.listen(this);
+}
+
+/**
+ *  Destructor.
+ */
+shell::~shell() throw () {
+  try {
+    _close_channel();
+    _session.unlisten(this);
+  }
+  catch (...) {}
+}
+
+/**
+ *  @brief Cancel a command.
+ *
+ *  A command that is already running cannot be interrupted, so the
+ *  remote shell is dropped and the next commands will run in a new
+ *  one.
+ *
+ *  @param[in] listnr Listener of the command.
+ */
+void shell::cancel(shell_listener* listnr) {
+  for (std::list<command>::iterator
+         it(_commands.begin()), end(_commands.end());
+       it != end;
+       ++it)
+    if (it->listnr == listnr) {
+      bool running(_running && (it == _commands.begin()));
+      _commands.erase(it);
+      if (running) {
+        log_info(logging::medium) << "dropping persistent shell of "
+          "session " << &_session << " to cancel running command";
+        _close_channel();
+        _process();
+        multiplexer::instance().handle_manager::update(
+          _session.get_socket_handle());
+      }
+      break ;
+    }
+  return ;
+}
+
+/**
+ *  Queue a command.
+ *
+ *  @param[in] listnr Listener that will be notified of the command
+ *                    outcome.
+ *  @param[in] cmd    Command to execute.
+ */
+void shell::execute(shell_listener* listnr, std::string const& cmd) {
+  command c;
+  c.cmd = cmd;
+  c.listnr = listnr;
+  _commands.push_back(c);
+  _process();
+  multiplexer::instance().handle_manager::update(
+    _session.get_socket_handle());
+  return ;
+}
+
+/**
+ *  Session is available.
+ *
+ *  @param[in] sess Unused.
+ */
+void shell::on_available(session& sess) {
+  (void)sess;
+  _process();
+  return ;
+}
+
+/**
+ *  Session is closing.
+ *
+ *  @param[in] sess Unused.
+ */
+void shell::on_close(session& sess) {
+  (void)sess;
+  _fail("session closed before command could execute");
+  return ;
+}
+
+/**
+ *  Session is connected.
+ *
+ *  @param[in] sess Unused.
+ */
+void shell::on_connected(session& sess) {
+  (void)sess;
+  _process();
+  return ;
+}
+
+/**
+ *  @brief Extract the result of a command wrapped by wrap() from the
+ *  shell output.
+ *
+ *  The delimiters are preceded by a newline, which is not part of the
+ *  command output. Data that follows the delimiters stays in the
+ *  buffers.
+ *
+ *  @param[in]     token      Delimiter of the command.
+ *  @param[in,out] out_buffer Shell output.
+ *  @param[in,out] err_buffer Shell error output.
+ *  @param[out]    out        Command output.
+ *  @param[out]    err        Command error output.
+ *  @param[out]    exit_code  Command exit code.
+ *
+ *  @return true if the command completed.
+ */
+bool shell::parse(
+              std::string const& token,
+              std::string& out_buffer,
+              std::string& err_buffer,
+              std::string& out,
+              std::string& err,
+              int& exit_code) {
+  std::string out_delim("\n" + token + " ");
+  std::string err_delim("\n" + token + "\n");
+  size_t out_pos(out_buffer.find(out_delim));
+  size_t err_pos(err_buffer.find(err_delim));
+  size_t code_end((out_pos == std::string::npos)
+                  ? std::string::npos
+                  : out_buffer.find('\n', out_pos + out_delim.size()));
+  if ((code_end == std::string::npos)
+      || (err_pos == std::string::npos))
+    return (false);
+  exit_code = strtol(
+                out_buffer.c_str() + out_pos + out_delim.size(),
+                NULL,
+                10);
+  out.assign(out_buffer, 0, out_pos);
+  err.assign(err_buffer, 0, err_pos);
+  out_buffer.erase(0, code_end + 1);
+  err_buffer.erase(0, err_pos + err_delim.size());
+  return (true);
+}
+
+/**
+ *  @brief Wrap a command with its delimiters.
+ *
+ *  The command runs in a subshell so that it cannot exit or alter the
+ *  persistent shell.
+ *
+ *  @param[in] cmd   Command.
+ *  @param[in] token Delimiter, that remote commands cannot guess.
+ *
+ *  @return Shell input.
+ */
+std::string shell::wrap(
+                     std::string const& cmd,
+                     std::string const& token) {
+  return ("( " + cmd + "\n) </dev/null; "
+          "printf '\\n%s %d\\n' " + token + " $?; "
+          "printf '\\n%s\\n' " + token + " >&2\n");
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Close the shell channel and release its slot.
+ */
+void shell::_close_channel() {
+  if (_channel) {
+    _session.close_channel(_channel);
+    _channel = NULL;
+  }
+  _session.release_channel(this);
+  _running = false;
+  _stderr.clear();
+  _stdout.clear();
+  _step = shell_open;
+  _wbuf.clear();
+  return ;
+}
+
+/**
+ *  Drop the shell and fail all queued commands.
+ *
+ *  @param[in] msg Error message.
+ */
+void shell::_fail(std::string const& msg) {
+  std::list<command> commands;
+  commands.swap(_commands);
+  _close_channel();
+  if (!commands.empty())
+    log_error(logging::medium) << "persistent shell of session "
+      << &_session << " failed: " << msg;
+  for (std::list<command>::const_iterator
+         it(commands.begin()), end(commands.end());
+       it != end;
+       ++it)
+    it->listnr->on_shell_error(msg);
+  return ;
+}
+
+/**
+ *  Attempt to open the shell channel.
+ *
+ *  @return true while the channel was not successfully opened.
+ */
+bool shell::_open() {
+  if (!_session.acquire_channel(this))
+    return (true);
+  _channel = _session.new_channel();
+  return (!_channel);
+}
+
+/**
+ *  Move the shell forward as far as possible without blocking.
+ */
+void shell::_process() {
+  if (_processing || !_session.is_connected())
+    return ;
+  _processing = true;
+  try {
+    bool again(true);
+    while (again) {
+      again = false;
+      if (_step == shell_open) {
+        if (_commands.empty() || _open())
+          break ;
+        log_info(logging::medium) << "persistent shell channel of "
+          "session " << &_session << " was opened";
+        _step = shell_start;
+      }
+      if (_step == shell_start) {
+        if (_start())
+          break ;
+        _step = shell_ready;
+      }
+      _write();
+      again = _read();
+    }
+  }
+  catch (std::exception const& e) {
+    _processing = false;
+    _fail(e.what());
+    return ;
+  }
+  _processing = false;
+  return ;
+}
+
+/**
+ *  Read shell output and notify the listener of a completed command.
+ *
+ *  @return true if a command completed.
+ */
+bool shell::_read() {
+  // Drain both streams.
+  char buffer[BUFSIZ];
+  for (int stream(0); stream < 2; ++stream) {
+    std::string& data(stream ? _stderr : _stdout);
+    int ret;
+    while ((ret = libssh2_channel_read_ex(
+                    _channel,
+                    stream,
+                    buffer,
+                    sizeof(buffer))) > 0)
+      data.append(buffer, ret);
+    if ((ret < 0) && (ret != LIBSSH2_ERROR_EAGAIN)) {
+      char* msg;
+      libssh2_session_last_error(
+        _session.get_libssh2_session(),
+        &msg,
+        NULL,
+        0);
+      if (ret == LIBSSH2_ERROR_SOCKET_SEND)
+        _session.error();
+      throw (basic_error() << "failed to read shell output: " << msg);
+    }
+  }
+
+  // Look for the delimiters of the running command.
+  if (_running) {
+    std::string out;
+    std::string err;
+    int exit_code;
+    if (parse(_token, _stdout, _stderr, out, err, exit_code)) {
+      shell_listener* listnr(_commands.front().listnr);
+      _commands.pop_front();
+      _running = false;
+      log_debug(logging::medium) << "persistent shell command "
+        << _token << " exited with code " << exit_code;
+      listnr->on_shell_result(out, err, exit_code);
+      return (true);
+    }
+  }
+
+  if (libssh2_channel_eof(_channel))
+    throw (basic_error() << "remote shell exited");
+  return (false);
+}
+
+/**
+ *  Attempt to start the remote shell.
+ *
+ *  @return true while the shell was not successfully started.
+ */
+bool shell::_start() {
+  int ret(libssh2_channel_exec(_channel, "/bin/sh"));
+  if (ret && (ret != LIBSSH2_ERROR_EAGAIN)) {
+    char* msg;
+    libssh2_session_last_error(
+      _session.get_libssh2_session(),
+      &msg,
+      NULL,
+      0);
+    if (ret == LIBSSH2_ERROR_SOCKET_SEND)
+      _session.error();
+    throw (basic_error() << "could not start remote shell: "
+           << msg << " (error " << ret << ")");
+  }
+  return (ret == LIBSSH2_ERROR_EAGAIN);
+}
+
+/**
+ *  Send the next command to the shell.
+ */
+void shell::_write() {
+  // Wrap next command with its delimiters.
+  if (!_running && !_commands.empty()) {
+    std::ostringstream oss;
+    oss << _token_prefix << ++_sequence;
+    _token = oss.str();
+    _wbuf = wrap(_commands.front().cmd, _token);
+    _running = true;
+    _stderr.clear();
+    _stdout.clear();
+    log_debug(logging::medium) << "sending command " << _token
+      << " to persistent shell of session " << &_session;
+  }
+
+  // Write as much as possible.
+  while (!_wbuf.empty()) {
+    ssize_t ret(libssh2_channel_write(
+                  _channel,
+                  _wbuf.data(),
+                  _wbuf.size()));
+    if (ret == LIBSSH2_ERROR_EAGAIN)
+      break ;
+    else if (ret < 0) {
+      char* msg;
+      libssh2_session_last_error(
+        _session.get_libssh2_session(),
+        &msg,
+        NULL,
+        0);
+      if (ret == LIBSSH2_ERROR_SOCKET_SEND)
+        _session.error();
+      throw (basic_error() << "failed to write to remote shell: "
+             << msg);
+    }
+    _wbuf.erase(0, ret);
+  }
+  return ;
+}
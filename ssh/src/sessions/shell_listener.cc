@@ -0,0 +1,58 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include "com/centreon/connector/ssh/sessions/shell_listener.hh"
+
+using namespace com::centreon::connector::ssh::sessions;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Default constructor.
+ */
+shell_listener::shell_listener() {}
+
+/**
+ *  Copy constructor.
+ *
+ *  @param[in] l Unused.
+ */
+shell_listener::shell_listener(shell_listener const& l) {
+  (void)l;
+}
+
+/**
+ *  Destructor.
+ */
+shell_listener::~shell_listener() {}
+
+/**
+ *  Assignment operator.
+ *
+ *  @param[in] l Unused.
+ *
+ *  @return This object.
+ */
+shell_listener& shell_listener::operator=(shell_listener const& l) {
+  (void)l;
+  return (*this);
+}
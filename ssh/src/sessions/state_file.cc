@@ -0,0 +1,190 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include "com/centreon/concurrency/locker.hh"
+#include "com/centreon/connector/ssh/sessions/state_file.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::ssh::sessions;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] path State file path, empty to disable state saving.
+ */
+state_file::state_file(std::string const& path) : _path(path) {}
+
+/**
+ *  Destructor.
+ */
+state_file::~state_file() throw () {}
+
+/**
+ *  Record credentials of an active session. This method can be called
+ *  from any thread.
+ *
+ *  @param[in] creds Session credentials.
+ */
+void state_file::add(credentials const& creds) {
+  if (_path.empty() || !creds.get_password().empty())
+    return ;
+  concurrency::locker lock(&_mutex);
+  _creds.insert(creds);
+  return ;
+}
+
+/**
+ *  Get the state file path.
+ *
+ *  @return State file path.
+ */
+std::string const& state_file::get_path() const throw () {
+  return (_path);
+}
+
+/**
+ *  @brief Read credentials saved by a previous run.
+ *
+ *  A missing file is not an error. Each line holds the host, port,
+ *  user and identity file of a session, separated by tabs, optionally
+ *  followed by its SSH options as space separated Name=Value pairs.
+ *
+ *  @param[out] creds Saved credentials.
+ */
+void state_file::read(std::list<credentials>& creds) const {
+  creds.clear();
+  if (_path.empty())
+    return ;
+  std::ifstream ifs(_path.c_str());
+  if (!ifs.good()) {
+    log_info(logging::medium) << "no session state could be read from "
+      << _path;
+    return ;
+  }
+  std::string line;
+  unsigned int line_nb(0);
+  while (std::getline(ifs, line)) {
+    ++line_nb;
+    if (line.empty() || (line[0] == '#'))
+      continue ;
+    size_t port_pos(line.find('\t'));
+    size_t user_pos((port_pos == std::string::npos)
+                    ? std::string::npos
+                    : line.find('\t', port_pos + 1));
+    size_t key_pos((user_pos == std::string::npos)
+                   ? std::string::npos
+                   : line.find('\t', user_pos + 1));
+    if (key_pos == std::string::npos) {
+      log_error(logging::medium) << "invalid line " << line_nb
+        << " in session state file " << _path;
+      continue ;
+    }
+    std::string port(line.substr(port_pos + 1, user_pos - port_pos - 1));
+    char* end(NULL);
+    unsigned long port_nb(strtoul(port.c_str(), &end, 10));
+    if (port.empty() || *end || !port_nb || (port_nb > 65535)) {
+      log_error(logging::medium) << "invalid port on line " << line_nb
+        << " of session state file " << _path;
+      continue ;
+    }
+    size_t opts_pos(line.find('\t', key_pos + 1));
+    std::map<std::string, std::string> opts;
+    if (opts_pos != std::string::npos) {
+      std::istringstream iss(line.substr(opts_pos + 1));
+      std::string opt;
+      while (iss >> opt) {
+        size_t eq(opt.find('='));
+        if ((eq != std::string::npos) && eq)
+          opts[opt.substr(0, eq)] = opt.substr(eq + 1);
+      }
+    }
+    credentials c;
+    c.set_host(line.substr(0, port_pos));
+    c.set_port(port_nb);
+    c.set_user(line.substr(user_pos + 1, key_pos - user_pos - 1));
+    c.set_key(line.substr(key_pos + 1, opts_pos - key_pos - 1));
+    c.set_ssh_options(opts);
+    creds.push_back(c);
+  }
+  log_info(logging::low) << creds.size()
+    << " sessions were read from state file " << _path;
+  return ;
+}
+
+/**
+ *  Write recorded credentials to the state file.
+ */
+void state_file::write() {
+  if (_path.empty())
+    return ;
+
+  // Write a temporary file that replaces the state file once complete.
+  std::string tmp(_path + ".new");
+  concurrency::locker lock(&_mutex);
+  {
+    std::ofstream ofs(tmp.c_str(), std::ios::out | std::ios::trunc);
+    if (!ofs.good())
+      throw (basic_error() << "could not open session state file '"
+             << tmp << "'");
+    ofs << "# Sessions of Centreon SSH Connector.\n"
+        << "# host\tport\tuser\tidentity file\tSSH options\n";
+    for (std::set<credentials>::const_iterator
+           it(_creds.begin()), end(_creds.end());
+         it != end;
+         ++it) {
+      ofs << it->get_host() << "\t" << it->get_port() << "\t"
+          << it->get_user() << "\t" << it->get_key() << "\t";
+      std::map<std::string, std::string> const&
+        opts(it->get_ssh_options());
+      for (std::map<std::string, std::string>::const_iterator
+             opt(opts.begin()), opts_end(opts.end());
+           opt != opts_end;
+           ++opt)
+        ofs << ((opt == opts.begin()) ? "" : " ")
+            << opt->first << "=" << opt->second;
+      ofs << "\n";
+    }
+    ofs.close();
+    if (ofs.fail())
+      throw (basic_error() << "could not write session state file '"
+             << tmp << "'");
+  }
+  if (rename(tmp.c_str(), _path.c_str())) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not replace session state file '"
+           << _path << "': " << msg);
+  }
+  log_info(logging::low) << _creds.size()
+    << " sessions were written to state file " << _path;
+  return ;
+}
@@ -0,0 +1,108 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include "com/centreon/connector/ssh/sessions/session.hh"
+#include "com/centreon/connector/ssh/sessions/timeout.hh"
+
+using namespace com::centreon::connector::ssh::sessions;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] sess Session that will be notified if timeout occurs.
+ */
+timeout::timeout(session* sess) : _session(sess) {}
+
+/**
+ *  Copy constructor.
+ *
+ *  @param[in] t Object to copy.
+ */
+timeout::timeout(timeout const& t) : com::centreon::task(t) {
+  _internal_copy(t);
+}
+
+/**
+ *  Destructor.
+ */
+timeout::~timeout() throw () {}
+
+/**
+ *  Assignment operator.
+ *
+ *  @param[in] t Object to copy.
+ *
+ *  @return This object.
+ */
+timeout& timeout::operator=(timeout const& t) {
+  if (this != &t) {
+    com::centreon::task::operator=(t);
+    _internal_copy(t);
+  }
+  return (*this);
+}
+
+/**
+ *  Get the session object.
+ *
+ *  @return Session object.
+ */
+session* timeout::get_session() const throw () {
+  return (_session);
+}
+
+/**
+ *  Notify session of timeout.
+ */
+void timeout::run() {
+  if (_session)
+    _session->on_timeout();
+  return ;
+}
+
+/**
+ *  Set target session.
+ *
+ *  @param[in] sess Target session.
+ */
+void timeout::set_session(session* sess) throw () {
+  _session = sess;
+  return ;
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Copy internal data members.
+ *
+ *  @param[in] t Object to copy.
+ */
+void timeout::_internal_copy(timeout const& t) {
+  _session = t._session;
+  return ;
+}
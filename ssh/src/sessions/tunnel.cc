@@ -0,0 +1,325 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include "com/centreon/connector/ssh/multiplexer.hh"
+#include "com/centreon/connector/ssh/sessions/session.hh"
+#include "com/centreon/connector/ssh/sessions/tunnel.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::ssh::sessions;
+
+// Data buffered in each direction before reading is paused.
+static size_t const buffer_size(65536);
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] bastion Session through which the tunnel is opened.
+ *  @param[in] host    Host the bastion connects to.
+ *  @param[in] port    Port the bastion connects to.
+ *  @param[in] handl   Local socket, owned by the tunnel afterwards.
+ */
+tunnel::tunnel(
+          session& bastion,
+          std::string const& host,
+          unsigned short port,
+          native_handle handl)
+  : _bastion(&bastion),
+    _channel(NULL),
+    _eof(false),
+    _host(host),
+    _port(port),
+    _socket(handl) {
+  multiplexer::instance().handle_manager::add(&_socket, this);
+  _bastion->listen(this);
+  on_available(*_bastion);
+}
+
+/**
+ *  Destructor.
+ */
+tunnel::~tunnel() throw () {
+  try {
+    _close();
+    if (_bastion)
+      _bastion->unlisten(this);
+  }
+  catch (...) {}
+}
+
+/**
+ *  Error on the local socket.
+ *
+ *  @param[in] h Unused.
+ */
+void tunnel::error(handle& h) {
+  (void)h;
+  log_error(logging::medium) << "error detected on tunnel to "
+    << _host << ":" << _port << ", closing it";
+  _close();
+  return ;
+}
+
+/**
+ *  Bastion session is available.
+ *
+ *  @param[in] sess Unused.
+ */
+void tunnel::on_available(session& sess) {
+  (void)sess;
+  try {
+    if (_channel)
+      _pump();
+    else
+      _open();
+  }
+  catch (std::exception const& e) {
+    log_error(logging::medium) << "tunnel to " << _host << ":"
+      << _port << " encountered an error: " << e.what();
+    _close();
+  }
+  return ;
+}
+
+/**
+ *  @brief Bastion session is closing.
+ *
+ *  The channel is freed along with the bastion session. The session
+ *  of the remote host gets the end of the local socket.
+ *
+ *  @param[in] sess Unused.
+ */
+void tunnel::on_close(session& sess) {
+  (void)sess;
+  log_info(logging::medium) << "bastion of tunnel to " << _host
+    << ":" << _port << " was closed";
+  _channel = NULL;
+  _close();
+  _bastion->unlisten(this);
+  _bastion = NULL;
+  return ;
+}
+
+/**
+ *  Bastion session is connected.
+ *
+ *  @param[in] sess Unused.
+ */
+void tunnel::on_connected(session& sess) {
+  on_available(sess);
+  return ;
+}
+
+/**
+ *  Data from the session of the remote host is available.
+ *
+ *  @param[in] h Unused.
+ */
+void tunnel::read(handle& h) {
+  (void)h;
+  if (_in.size() < buffer_size) {
+    char buffer[4096];
+    ssize_t rb(::read(_socket.get_native_handle(), buffer, sizeof(buffer)));
+    if (rb < 0) {
+      if ((errno == EAGAIN) || (errno == EINTR))
+        return ;
+      char const* msg(strerror(errno));
+      log_error(logging::medium) << "could not read tunnel to "
+        << _host << ":" << _port << ": " << msg;
+      _close();
+      return ;
+    }
+    else if (!rb) {
+      log_debug(logging::medium) << "tunnel to " << _host << ":"
+        << _port << " was closed by its session";
+      _close();
+      return ;
+    }
+    _in.append(buffer, rb);
+  }
+  if (_bastion)
+    on_available(*_bastion);
+  return ;
+}
+
+/**
+ *  Check if the local socket should be read.
+ *
+ *  @param[in] h Unused.
+ *
+ *  @return true if there is room for more data.
+ */
+bool tunnel::want_read(handle& h) {
+  (void)h;
+  return (_in.size() < buffer_size);
+}
+
+/**
+ *  Check if the local socket should be written.
+ *
+ *  @param[in] h Unused.
+ *
+ *  @return true if data from the bastion is waiting.
+ */
+bool tunnel::want_write(handle& h) {
+  (void)h;
+  return (!_out.empty());
+}
+
+/**
+ *  Local socket can be written.
+ *
+ *  @param[in] h Unused.
+ */
+void tunnel::write(handle& h) {
+  (void)h;
+  if (_bastion)
+    on_available(*_bastion);
+  return ;
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Close the channel and the local socket.
+ */
+void tunnel::_close() {
+  if (_socket.get_native_handle() != native_handle_null) {
+    multiplexer::instance().handle_manager::remove(&_socket);
+    _socket.close();
+  }
+  if (_channel) {
+    _bastion->close_channel(_channel);
+    _channel = NULL;
+  }
+  _in.clear();
+  _out.clear();
+  return ;
+}
+
+/**
+ *  Write data from the bastion to the local socket.
+ */
+void tunnel::_flush() {
+  while (!_out.empty()) {
+    ssize_t wb(::write(
+                 _socket.get_native_handle(),
+                 _out.data(),
+                 _out.size()));
+    if (wb < 0) {
+      if ((errno == EAGAIN) || (errno == EINTR))
+        break ;
+      char const* msg(strerror(errno));
+      throw (basic_error() << "could not write tunnel: " << msg);
+    }
+    _out.erase(0, wb);
+  }
+  return ;
+}
+
+/**
+ *  Attempt to open the direct-tcpip channel.
+ */
+void tunnel::_open() {
+  if (_channel
+      || !_bastion
+      || !_bastion->is_connected()
+      || (_socket.get_native_handle() == native_handle_null))
+    return ;
+  _channel = _bastion->new_direct_channel(_host, _port);
+  if (_channel) {
+    log_info(logging::medium) << "tunnel to " << _host << ":"
+      << _port << " opened through session "
+      << _bastion->get_credentials().get_user() << "@"
+      << _bastion->get_credentials().get_host() << ":"
+      << _bastion->get_credentials().get_port();
+    _pump();
+  }
+  return ;
+}
+
+/**
+ *  Relay data in both directions.
+ */
+void tunnel::_pump() {
+  if (_socket.get_native_handle() == native_handle_null)
+    return ;
+
+  // Bastion to local socket.
+  while (!_eof && (_out.size() < buffer_size)) {
+    char buffer[4096];
+    ssize_t rb(libssh2_channel_read(_channel, buffer, sizeof(buffer)));
+    if (rb == LIBSSH2_ERROR_EAGAIN)
+      break ;
+    else if (rb < 0)
+      throw (basic_error() << "could not read from channel (error "
+             << rb << ")");
+    else if (!rb) {
+      _eof = libssh2_channel_eof(_channel);
+      break ;
+    }
+    _out.append(buffer, rb);
+  }
+  _flush();
+
+  // Local socket to bastion.
+  while (!_in.empty()) {
+    ssize_t wb(libssh2_channel_write(_channel, _in.data(), _in.size()));
+    if (wb == LIBSSH2_ERROR_EAGAIN)
+      break ;
+    else if (wb < 0)
+      throw (basic_error() << "could not write to channel (error "
+             << wb << ")");
+    _in.erase(0, wb);
+  }
+
+  // Remote end closed the connection.
+  if (_eof && _out.empty()) {
+    log_debug(logging::medium) << "tunnel to " << _host << ":"
+      << _port << " was closed by the remote host";
+    _close();
+    return ;
+  }
+  _update();
+  return ;
+}
+
+/**
+ *  Refresh the interest of the local socket and of the bastion.
+ */
+void tunnel::_update() {
+  multiplexer::instance().handle_manager::update(&_socket);
+  multiplexer::instance().handle_manager::update(
+    _bastion->get_socket_handle());
+  return ;
+}
@@ -0,0 +1,180 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "com/centreon/connector/ssh/wakeup.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::ssh;
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Default constructor.
+ */
+wakeup::wakeup() {
+  if (pipe(_fds)) {
+    char const* msg(strerror(errno));
+    throw (basic_error() << "could not create wakeup pipe: " << msg);
+  }
+
+  // Both ends are non-blocking: a full pipe already means that the
+  // multiplexing thread will wake up.
+  for (unsigned int i(0); i < 2; ++i) {
+    int flags(fcntl(_fds[i], F_GETFL));
+    if ((flags < 0)
+        || (fcntl(_fds[i], F_SETFL, flags | O_NONBLOCK) == -1)) {
+      char const* msg(strerror(errno));
+      close();
+      throw (basic_error()
+             << "could not make wakeup pipe non blocking: " << msg);
+    }
+  }
+}
+
+/**
+ *  Destructor.
+ */
+wakeup::~wakeup() throw () {
+  close();
+}
+
+/**
+ *  Close both ends of the pipe.
+ */
+void wakeup::close() {
+  for (unsigned int i(0); i < 2; ++i)
+    if (_fds[i] != native_handle_null) {
+      ::close(_fds[i]);
+      _fds[i] = native_handle_null;
+    }
+  return ;
+}
+
+/**
+ *  Error callback (from I/O multiplexing).
+ *
+ *  @param[in] h Unused.
+ */
+void wakeup::error(handle& h) {
+  (void)h;
+  throw (basic_error() << "error detected on wakeup pipe");
+  return ;
+}
+
+/**
+ *  Get the read end of the pipe.
+ *
+ *  @return Native handle monitored by the multiplexer.
+ */
+native_handle wakeup::get_native_handle() {
+  return (_fds[0]);
+}
+
+/**
+ *  Read from the pipe.
+ *
+ *  @param[out] data Where data will be stored.
+ *  @param[in]  size How much data in bytes to read at most.
+ *
+ *  @return Number of bytes actually read.
+ */
+unsigned long wakeup::read(void* data, unsigned long size) {
+  ssize_t rb(::read(_fds[0], data, size));
+  if (rb < 0) {
+    if ((errno == EAGAIN) || (errno == EINTR))
+      return (0);
+    char const* msg(strerror(errno));
+    throw (basic_error() << "wakeup pipe read error: " << msg);
+  }
+  return (rb);
+}
+
+/**
+ *  Drain pending wakeup notifications.
+ *
+ *  @param[in] h Handle.
+ */
+void wakeup::read(handle& h) {
+  char buffer[64];
+  while (h.read(buffer, sizeof(buffer)) == sizeof(buffer))
+    ;
+  return ;
+}
+
+/**
+ *  Wake up the multiplexing thread. This method can be called from
+ *  any thread.
+ */
+void wakeup::wake() {
+  char c(0);
+  write(&c, sizeof(c));
+  return ;
+}
+
+/**
+ *  Read monitoring is always wanted.
+ *
+ *  @param[in] h Unused.
+ *
+ *  @return true.
+ */
+bool wakeup::want_read(handle& h) {
+  (void)h;
+  return (true);
+}
+
+/**
+ *  Write monitoring is never wanted.
+ *
+ *  @param[in] h Unused.
+ *
+ *  @return false.
+ */
+bool wakeup::want_write(handle& h) {
+  (void)h;
+  return (false);
+}
+
+/**
+ *  Write to the pipe.
+ *
+ *  @param[in] data Data to write.
+ *  @param[in] size How much data to write at most.
+ *
+ *  @return Number of bytes actually written.
+ */
+unsigned long wakeup::write(void const* data, unsigned long size) {
+  ssize_t wb(::write(_fds[1], data, size));
+  if (wb < 0) {
+    if ((errno == EAGAIN) || (errno == EINTR))
+      return (0);
+    char const* msg(strerror(errno));
+    throw (basic_error() << "wakeup pipe write error: " << msg);
+  }
+  return (wb);
+}
@@ -0,0 +1,998 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <set>
+#include <sstream>
+#include "com/centreon/concurrency/locker.hh"
+#include "com/centreon/connector/ssh/checks/check.hh"
+#include "com/centreon/connector/ssh/checks/result.hh"
+#include "com/centreon/connector/ssh/multiplexer.hh"
+#include "com/centreon/connector/ssh/options.hh"
+#include "com/centreon/connector/ssh/sessions/session.hh"
+#include "com/centreon/connector/ssh/sessions/state_file.hh"
+#include "com/centreon/connector/ssh/worker.hh"
+#include "com/centreon/delayed_delete.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/logger.hh"
+
+using namespace com::centreon;
+using namespace com::centreon::connector::ssh;
+
+// Simultaneous handshakes of warm start when they are not limited.
+static unsigned int const warm_start_handshakes(4);
+
+/**************************************
+*                                     *
+*           Public Methods            *
+*                                     *
+**************************************/
+
+/**
+ *  Constructor.
+ *
+ *  @param[in] opts   Program options.
+ *  @param[in] listnr Listener that will receive check results.
+ */
+worker::worker(options const& opts, checks::listener* listnr)
+  : _backoff_max(opts.get_backoff_max()),
+    _backoff_min(opts.get_backoff_min()),
+    _connect_rate(opts.get_connect_rate()),
+    _connect_timeout(opts.get_connect_timeout()),
+    _idle_timeout(opts.get_idle_timeout()),
+    _keepalive_count(opts.get_keepalive_count()),
+    _keepalive_interval(opts.get_keepalive_interval()),
+    _listnr(listnr),
+    _max_channels(opts.get_max_channels()),
+    _max_handshakes(opts.get_max_handshakes()),
+    _max_sessions(opts.get_max_sessions()),
+    _parallel_commands(opts.get_parallel_commands()),
+    _persistent_shell(opts.get_persistent_shell()),
+    _quit(false),
+    _reaper(0),
+    _state(NULL),
+    _threaded(false),
+    _tokens_time(timestamp::now()) {
+  // Limits are shared among worker threads.
+  unsigned int workers(opts.get_workers());
+  if (workers > 1) {
+    if (_connect_rate)
+      _connect_rate = (_connect_rate + workers - 1) / workers;
+    if (_max_handshakes)
+      _max_handshakes = (_max_handshakes + workers - 1) / workers;
+    if (_max_sessions)
+      _max_sessions = (_max_sessions + workers - 1) / workers;
+  }
+  _tokens = _connect_rate;
+}
+
+/**
+ *  Destructor.
+ */
+worker::~worker() throw () {
+  try {
+    stop();
+  }
+  catch (...) {}
+  _clear();
+}
+
+/**
+ *  @brief Connect a session in advance.
+ *
+ *  The session is connected in the background, after sessions needed
+ *  by checks.
+ *
+ *  @param[in] creds Session credentials.
+ */
+void worker::connect(sessions::credentials const& creds) {
+  execute(0, 0, creds, std::list<std::string>(), -1, -1, false);
+  return ;
+}
+
+/**
+ *  @brief Execute a check.
+ *
+ *  If the worker runs its own thread, the order is queued and will be
+ *  processed by the worker thread. Otherwise it is processed
+ *  immediately.
+ *
+ *  @param[in] cmd_id      Command ID.
+ *  @param[in] timeout     Time the command has to execute.
+ *  @param[in] creds       Session credentials.
+ *  @param[in] cmds        Commands to execute.
+ *  @param[in] skip_stdout Ignore all or first n output lines.
+ *  @param[in] skip_stderr Ignore all or first n error lines.
+ *  @param[in] use_ipv6    Version of ip protocol to use.
+ */
+void worker::execute(
+               unsigned long long cmd_id,
+               time_t timeout,
+               sessions::credentials const& creds,
+               std::list<std::string> const& cmds,
+               int skip_stdout,
+               int skip_stderr,
+               bool use_ipv6) {
+  order o;
+  o.cmd_id = cmd_id;
+  o.cmds = cmds;
+  o.creds = creds;
+  o.skip_stderr = skip_stderr;
+  o.skip_stdout = skip_stdout;
+  o.timeout = timeout;
+  o.use_ipv6 = use_ipv6;
+  if (_threaded) {
+    {
+      concurrency::locker lock(&_mutex);
+      _orders.push_back(o);
+    }
+    _wakeup.wake();
+  }
+  else
+    _execute(o);
+  return ;
+}
+
+/**
+ *  Check result has arrived.
+ *
+ *  @param[in] r Check result.
+ */
+void worker::on_result(checks::result const& r) {
+  // Remove check from list.
+  std::map<unsigned long long, std::pair<checks::check*, sessions::session*> >::iterator chk;
+  chk = _checks.find(r.get_command_id());
+  if (chk == _checks.end())
+    log_error(logging::medium) << "got result of check "
+      << r.get_command_id() << " which is not registered";
+  else {
+    try {
+      chk->second.first->unlisten(this);
+      chk->second.second->unlisten(chk->second.first);
+    }
+    catch (...) {}
+    delete chk->second.first;
+    sessions::session* sess(chk->second.second);
+    _checks.erase(chk);
+    _last_used[sess] = timestamp::now();
+
+    // Check session.
+    if (sess->is_connected())
+      _failures.erase(sess->get_credentials());
+    else {
+      log_debug(logging::medium) << "session " << sess << " is not"
+           " connected, checking if any check working with it remains";
+      if (!_is_used(sess)) {
+        log_info(logging::high) << "session "
+          << sess->get_credentials().get_user() << "@"
+          << sess->get_credentials().get_host() << ":"
+          << sess->get_credentials().get_port()
+          << " that is not connected and has "
+             "no check running will be deleted";
+        // A session that died or never started can be reopened
+        // right away.
+        if (!_is_queued(sess) && !sess->is_dead())
+          _failed(sess->get_credentials());
+        _delete_session(sess);
+      }
+    }
+  }
+
+  // Forward check result.
+  if (_listnr)
+    _listnr->on_result(r);
+
+  return ;
+}
+
+/**
+ *  Reap idle sessions and start queued ones (task callback).
+ */
+void worker::run() {
+  _reaper = 0;
+  _reap(_max_sessions);
+  _start_sessions();
+  _schedule_reaper();
+  return ;
+}
+
+/**
+ *  Set the state file recording sessions on exit.
+ *
+ *  @param[in] state State file, NULL to disable.
+ */
+void worker::set_state_file(sessions::state_file* state) throw () {
+  _state = state;
+  return ;
+}
+
+/**
+ *  Run the worker in its own thread.
+ */
+void worker::start() {
+  _threaded = true;
+  exec();
+  return ;
+}
+
+/**
+ *  @brief Stop the worker thread.
+ *
+ *  The thread exits once all its checks have terminated. This method
+ *  waits for the thread termination.
+ */
+void worker::stop() {
+  if (_threaded) {
+    {
+      concurrency::locker lock(&_mutex);
+      _quit = true;
+    }
+    _wakeup.wake();
+    wait();
+    _threaded = false;
+  }
+  return ;
+}
+
+/**************************************
+*                                     *
+*          Protected Methods          *
+*                                     *
+**************************************/
+
+/**
+ *  Worker thread entry point.
+ */
+void worker::_run() {
+  multiplexer::load();
+  try {
+    multiplexer::instance().handle_manager::add(&_wakeup, &_wakeup);
+    for (;;) {
+      _process_orders();
+      {
+        concurrency::locker lock(&_mutex);
+        if (_quit && _orders.empty() && _checks.empty())
+          break ;
+      }
+      log_debug(logging::high) << "worker " << this << " multiplexing";
+      multiplexer::instance().multiplex();
+    }
+    multiplexer::instance().handle_manager::remove(
+      static_cast<handle*>(&_wakeup));
+  }
+  catch (std::exception const& e) {
+    log_error(logging::low) << "worker " << this
+      << " stopped because an error occurred: " << e.what();
+  }
+  _clear();
+  multiplexer::unload();
+  return ;
+}
+
+/**************************************
+*                                     *
+*           Private Methods           *
+*                                     *
+**************************************/
+
+/**
+ *  Delete all checks and sessions.
+ */
+void worker::_clear() {
+  // Stop reaper.
+  if (_reaper) {
+    try {
+      multiplexer::instance().task_manager::remove(_reaper);
+    }
+    catch (...) {}
+    _reaper = 0;
+  }
+
+  // Close checks.
+  for (std::map<
+         unsigned long long,
+         std::pair<checks::check*, sessions::session*> >::iterator
+         it = _checks.begin(),
+         end = _checks.end();
+       it != end;
+       ++it) {
+    try {
+      it->second.first->unlisten(this);
+    }
+    catch (...) {}
+    delete it->second.first;
+  }
+  _checks.clear();
+
+  // Close sessions.
+  for (std::map<sessions::credentials, sessions::session*>::iterator
+         it = _sessions.begin(),
+         end = _sessions.end();
+       it != end;
+       ++it) {
+    try {
+      if (_state && it->second->is_connected())
+        _state->add(it->first);
+      it->second->close();
+    }
+    catch (...) {}
+    delete it->second;
+  }
+  _sessions.clear();
+  _connect_queue.clear();
+  _connecting.clear();
+  _last_used.clear();
+  _warm_queue.clear();
+  return ;
+}
+
+/**
+ *  @brief Get the bastion session of some credentials.
+ *
+ *  Bastion sessions are shared by all sessions using the same jump
+ *  host. They are queued like other sessions, with the deadline of the
+ *  earliest session waiting for them. A closed bastion session is
+ *  replaced.
+ *
+ *  @param[in] creds    Credentials of the session connecting through
+ *                      the bastion.
+ *  @param[in] deadline Deadline of the session connecting through the
+ *                      bastion.
+ *
+ *  @return Bastion session, NULL if the session connects directly.
+ */
+sessions::session* worker::_bastion_of(
+                             sessions::credentials const& creds,
+                             time_t deadline) {
+  std::map<std::string, std::string> opts(creds.get_ssh_options());
+  std::map<std::string, std::string>::iterator
+    jump(opts.find("ProxyJump"));
+  if (jump == opts.end())
+    return (NULL);
+  if (jump->second.find(',') != std::string::npos)
+    throw (basic_error() << "jump host list '" << jump->second
+           << "' is not supported, only a single jump host is");
+
+  // Jump host is [user@]host[:port], the bastion uses the same
+  // authentication and transport options.
+  std::string host(jump->second);
+  std::string user(creds.get_user());
+  unsigned short port(22);
+  size_t at(host.rfind('@'));
+  if (at != std::string::npos) {
+    user = host.substr(0, at);
+    host.erase(0, at + 1);
+  }
+  std::string port_str;
+  if (!host.empty() && (host[0] == '[')) {
+    size_t bracket(host.find(']'));
+    if ((bracket != std::string::npos)
+        && (host.find(':', bracket) == bracket + 1))
+      port_str = host.substr(bracket + 2);
+    host = host.substr(1, bracket - 1);
+  }
+  else if (host.find(':') == host.rfind(':')) {
+    size_t colon(host.find(':'));
+    if (colon != std::string::npos) {
+      port_str = host.substr(colon + 1);
+      host.erase(colon);
+    }
+  }
+  if (!port_str.empty()) {
+    char* end(NULL);
+    unsigned long value(strtoul(port_str.c_str(), &end, 10));
+    if (*end || !value || (value > 65535))
+      throw (basic_error() << "invalid port in jump host '"
+             << jump->second << "'");
+    port = value;
+  }
+  opts.erase(jump);
+  sessions::credentials bastion_creds(creds);
+  bastion_creds.set_host(host);
+  bastion_creds.set_port(port);
+  bastion_creds.set_ssh_options(opts);
+  bastion_creds.set_user(user);
+
+  // Reuse the bastion session unless it was closed.
+  std::map<sessions::credentials, sessions::session*>::iterator
+    it(_sessions.find(bastion_creds));
+  if (it != _sessions.end()) {
+    if (it->second->is_connected() || it->second->is_connecting())
+      return (it->second);
+    if (_is_queued(it->second)) {
+      _warm_queue.remove(it->second);
+      _queue_session(it->second, false, deadline);
+      return (it->second);
+    }
+    log_info(logging::medium) << "bastion session "
+      << user << "@" << host << ":" << port
+      << " is closed and will be reopened";
+    _delete_session(it->second);
+  }
+
+  log_info(logging::low) << "creating bastion session for "
+    << user << "@" << host << ":" << port;
+  std::auto_ptr<sessions::session>
+    sess(new sessions::session(bastion_creds));
+  sess->set_connect_timeout(_connect_timeout);
+  sess->set_keepalive(_keepalive_interval, _keepalive_count);
+  sess->set_max_channels(_max_channels);
+  _sessions[bastion_creds] = sess.get();
+  _last_used[sess.get()] = timestamp::now();
+  _queue_session(sess.get(), false, deadline);
+  return (sess.release());
+}
+
+/**
+ *  @brief Close and delete a session.
+ *
+ *  The session is deleted on next task manager execution as it might
+ *  still be in use in the current call stack.
+ *
+ *  @param[in] sess Session to delete.
+ */
+void worker::_delete_session(sessions::session* sess) {
+  std::map<sessions::credentials, sessions::session*>::iterator
+    it(_sessions.find(sess->get_credentials()));
+  if ((it == _sessions.end()) || (it->second != sess))
+    log_error(logging::high) << "session " << sess
+      << " was not found in worker list, deleting anyway";
+  else
+    _sessions.erase(it);
+  _last_used.erase(sess);
+  _connecting.erase(sess);
+  for (std::list<queued_session>::iterator
+         it(_connect_queue.begin()), end(_connect_queue.end());
+       it != end;
+       ++it)
+    if (it->sess == sess) {
+      _connect_queue.erase(it);
+      break ;
+    }
+  _warm_queue.remove(sess);
+  for (std::map<sessions::credentials, sessions::session*>::iterator
+         it(_sessions.begin()), end(_sessions.end());
+       it != end;
+       ++it)
+    if (it->second->get_bastion() == sess)
+      it->second->set_bastion(NULL);
+  try {
+    sess->close();
+  }
+  catch (...) {}
+
+  // Delete from this thread, session destruction uses its
+  // thread-specific multiplexer.
+  std::auto_ptr<delayed_delete<sessions::session> >
+    dd(new delayed_delete<sessions::session>(sess));
+  multiplexer::instance().task_manager::add(
+    dd.get(),
+    0,
+    false,
+    true);
+  dd.release();
+  return ;
+}
+
+/**
+ *  @brief Record a connection failure.
+ *
+ *  New checks with the same credentials will fail immediately until
+ *  the backoff delay expires.
+ *
+ *  @param[in] creds Credentials of the session that failed.
+ */
+void worker::_failed(sessions::credentials const& creds) {
+  if (!_backoff_min)
+    return ;
+  timestamp now(timestamp::now());
+
+  // Forget failures that are too old to matter.
+  std::map<sessions::credentials, failure>::iterator
+    it(_failures.begin());
+  while (it != _failures.end()) {
+    timestamp expiry(it->second.retry);
+    expiry.add_seconds(_backoff_max);
+    if (expiry < now)
+      _failures.erase(it++);
+    else
+      ++it;
+  }
+
+  // Double delay on each consecutive failure.
+  it = _failures.find(creds);
+  if (it == _failures.end()) {
+    failure f;
+    f.count = 0;
+    it = _failures.insert(std::make_pair(creds, f)).first;
+  }
+  failure& f(it->second);
+  ++f.count;
+  unsigned int delay(_backoff_min);
+  for (unsigned int i(1); (i < f.count) && (delay < _backoff_max); ++i)
+    delay *= 2;
+  if (delay > _backoff_max)
+    delay = _backoff_max;
+  f.retry = now;
+  f.retry.add_seconds(delay);
+  log_info(logging::medium) << "connection to "
+    << creds.get_user() << "@" << creds.get_host() << ":"
+    << creds.get_port() << " failed " << f.count
+    << " times in a row, checks will fail for " << delay << " seconds";
+  return ;
+}
+
+/**
+ *  Execute a check order.
+ *
+ *  @param[in] o Order.
+ */
+void worker::_execute(order const& o) {
+  try {
+    // Checks that expired while they were queued are not executed.
+    if (o.cmd_id && (o.timeout <= time(NULL))) {
+      log_info(logging::medium) << "check " << o.cmd_id
+        << " reached timeout before it could be executed";
+      checks::result r;
+      r.set_command_id(o.cmd_id);
+      r.set_error("check reached timeout before it could be executed");
+      if (_listnr)
+        _listnr->on_result(r);
+      return ;
+    }
+
+    // Find session.
+    std::map<sessions::credentials, sessions::session*>::iterator it;
+    it = _sessions.find(o.creds);
+    bool queued(false);
+    bool queue_was_empty(_connect_queue.empty() && _warm_queue.empty());
+
+    // Replace a session that was closed while it was idle.
+    if ((it != _sessions.end())
+        && !it->second->is_connected()
+        && !it->second->is_connecting()
+        && !_is_queued(it->second)
+        && !_is_used(it->second)) {
+      log_info(logging::medium) << "session "
+        << o.creds.get_user() << "@" << o.creds.get_host() << ":"
+        << o.creds.get_port() << " is closed and will be reopened";
+      _delete_session(it->second);
+      it = _sessions.end();
+    }
+    // A check needs a session waiting to be connected.
+    else if ((it != _sessions.end())
+             && !o.cmds.empty()
+             && _is_queued(it->second)) {
+      _warm_queue.remove(it->second);
+      _queue_session(it->second, o.use_ipv6, o.timeout);
+      queued = true;
+    }
+
+    if (it == _sessions.end()) {
+      // Fail fast if host could not be reached recently.
+      std::map<sessions::credentials, failure>::const_iterator
+        f(_failures.find(o.creds));
+      timestamp now(timestamp::now());
+      if ((f != _failures.end()) && (now < f->second.retry)) {
+        if (!o.cmd_id)
+          return ;
+        std::ostringstream oss;
+        oss << "connection to " << o.creds.get_user() << "@"
+            << o.creds.get_host() << ":" << o.creds.get_port()
+            << " failed " << f->second.count
+            << " times in a row, next attempt in "
+            << (f->second.retry.to_seconds() - now.to_seconds())
+            << " seconds";
+        log_info(logging::medium) << "check " << o.cmd_id
+          << " fails immediately: " << oss.str();
+        checks::result r;
+        r.set_command_id(o.cmd_id);
+        r.set_error(oss.str());
+        if (_listnr)
+          _listnr->on_result(r);
+        return ;
+      }
+
+      // Make room for the new session.
+      if (_max_sessions && (_sessions.size() >= _max_sessions))
+        _reap(_max_sessions - 1);
+
+      log_info(logging::low) << "creating session for "
+        << o.creds.get_user() << "@" << o.creds.get_host()
+        << ":" << o.creds.get_port();
+      std::auto_ptr<sessions::session>
+        sess(new sessions::session(o.creds));
+      sess->set_connect_timeout(_connect_timeout);
+      sess->set_keepalive(_keepalive_interval, _keepalive_count);
+      sess->set_max_channels(_max_channels);
+      sess->set_persistent_shell(_persistent_shell);
+      _sessions[o.creds] = sess.get();
+      if (o.cmds.empty())
+        _warm_queue.push_back(sess.get());
+      else
+        _queue_session(sess.get(), o.use_ipv6, o.timeout);
+      sess.release();
+      it = _sessions.find(o.creds);
+      queued = true;
+    }
+    _last_used[it->second] = timestamp::now();
+
+    // Warm start only needs the session.
+    if (o.cmds.empty()) {
+      if (queued) {
+        _start_sessions();
+        _schedule_reaper(queue_was_empty);
+      }
+      return ;
+    }
+
+    // Create check object.
+    std::auto_ptr<checks::check> chk(new checks::check(
+                                                   o.skip_stdout,
+                                                   o.skip_stderr));
+    chk->listen(this);
+    chk->set_parallel(_parallel_commands);
+    _checks[o.cmd_id] = std::make_pair(chk.get(), it->second);
+    checks::check* chk_ptr(chk.release());
+
+    // Run copied pointer (we might be called in on_result()).
+    chk_ptr->execute(*it->second, o.cmd_id, o.cmds, o.timeout);
+
+    // Connect new session now that its check listens to it, or
+    // later if too many sessions are being connected.
+    if (queued) {
+      _start_sessions();
+      _schedule_reaper(queue_was_empty);
+    }
+  }
+  catch (std::exception const& e) {
+    log_error(logging::low) << "could not launch check ID "
+      << o.cmd_id << " on host " << o.creds.get_host()
+      << " because an error occurred: " << e.what();
+    // Warm start orders have no check to answer.
+    if (o.cmd_id) {
+      checks::result r;
+      r.set_command_id(o.cmd_id);
+      on_result(r);
+    }
+  }
+  catch (...) {
+    log_error(logging::low) << "could not launch check ID "
+      << o.cmd_id << " on host " << o.creds.get_host()
+      << " because an error occurred";
+    // Warm start orders have no check to answer.
+    if (o.cmd_id) {
+      checks::result r;
+      r.set_command_id(o.cmd_id);
+      on_result(r);
+    }
+  }
+  return ;
+}
+
+/**
+ *  Check whether a session waits to be connected.
+ *
+ *  @param[in] sess Session.
+ *
+ *  @return true if the session has not been connected yet.
+ */
+bool worker::_is_queued(sessions::session* sess) const {
+  for (std::list<queued_session>::const_iterator
+         it(_connect_queue.begin()), end(_connect_queue.end());
+       it != end;
+       ++it)
+    if (it->sess == sess)
+      return (true);
+  return (std::find(_warm_queue.begin(), _warm_queue.end(), sess)
+          != _warm_queue.end());
+}
+
+/**
+ *  Check whether a session is used by a running check or by sessions
+ *  connecting through it.
+ *
+ *  @param[in] sess Session.
+ *
+ *  @return true if the session is in use.
+ */
+bool worker::_is_used(sessions::session* sess) const {
+  for (std::map<
+         unsigned long long,
+         std::pair<checks::check*, sessions::session*> >::const_iterator
+         it(_checks.begin()), end(_checks.end());
+       it != end;
+       ++it)
+    if (it->second.second == sess)
+      return (true);
+  for (std::map<sessions::credentials, sessions::session*>::const_iterator
+         it(_sessions.begin()), end(_sessions.end());
+       it != end;
+       ++it)
+    if (it->second->get_bastion() == sess)
+      return (true);
+  return (false);
+}
+
+/**
+ *  Process orders queued by other threads.
+ */
+void worker::_process_orders() {
+  std::list<order> orders;
+  {
+    concurrency::locker lock(&_mutex);
+    orders.swap(_orders);
+  }
+  for (std::list<order>::const_iterator
+         it(orders.begin()), end(orders.end());
+       it != end;
+       ++it)
+    _execute(*it);
+  return ;
+}
+
+/**
+ *  @brief Queue a session until it can be connected.
+ *
+ *  Sessions are connected by earliest deadline of the checks waiting
+ *  for them.
+ *
+ *  @param[in] sess     Session.
+ *  @param[in] use_ipv6 Connect using IPv6.
+ *  @param[in] deadline Deadline of a check waiting for the session.
+ */
+void worker::_queue_session(
+               sessions::session* sess,
+               bool use_ipv6,
+               time_t deadline) {
+  for (std::list<queued_session>::iterator
+         it(_connect_queue.begin()), end(_connect_queue.end());
+       it != end;
+       ++it)
+    if (it->sess == sess) {
+      if (it->deadline <= deadline)
+        return ;
+      _connect_queue.erase(it);
+      break ;
+    }
+  queued_session q;
+  q.deadline = deadline;
+  q.sess = sess;
+  q.use_ipv6 = use_ipv6;
+  std::list<queued_session>::iterator it(_connect_queue.begin());
+  while ((it != _connect_queue.end()) && (it->deadline <= deadline))
+    ++it;
+  _connect_queue.insert(it, q);
+  return ;
+}
+
+/**
+ *  @brief Close idle sessions.
+ *
+ *  Sessions that did not run any check for the idle timeout are
+ *  closed. Then least recently used idle sessions are closed as long
+ *  as there are more than max sessions.
+ *
+ *  @param[in] max Maximum number of sessions that can remain open
+ *                 if a session limit is configured.
+ */
+void worker::_reap(unsigned int max) {
+  // Sessions used by running checks cannot be closed.
+  std::set<sessions::session*> busy;
+  for (std::map<
+         unsigned long long,
+         std::pair<checks::check*, sessions::session*> >::const_iterator
+         it(_checks.begin()), end(_checks.end());
+       it != end;
+       ++it)
+    busy.insert(it->second.second);
+
+  // Bastions are kept as long as sessions connect through them.
+  for (std::map<sessions::credentials, sessions::session*>::const_iterator
+         it(_sessions.begin()), end(_sessions.end());
+       it != end;
+       ++it)
+    if (it->second->get_bastion())
+      busy.insert(it->second->get_bastion());
+
+  // Sort idle sessions from least recently used.
+  time_t now(timestamp::now().to_seconds());
+  std::list<sessions::session*> expired;
+  std::multimap<timestamp, sessions::session*> idle;
+  for (std::map<sessions::session*, timestamp>::const_iterator
+         it(_last_used.begin()), end(_last_used.end());
+       it != end;
+       ++it)
+    if (busy.find(it->first) == busy.end()) {
+      if (_idle_timeout
+          && (it->second.to_seconds() + _idle_timeout <= now))
+        expired.push_back(it->first);
+      else
+        idle.insert(std::make_pair(it->second, it->first));
+    }
+
+  // Close expired sessions.
+  for (std::list<sessions::session*>::const_iterator
+         it(expired.begin()), end(expired.end());
+       it != end;
+       ++it) {
+    log_info(logging::medium) << "session "
+      << (*it)->get_credentials().get_user() << "@"
+      << (*it)->get_credentials().get_host() << ":"
+      << (*it)->get_credentials().get_port()
+      << " was idle for more than " << _idle_timeout
+      << " seconds and will be closed";
+    _delete_session(*it);
+  }
+
+  // Enforce session limit.
+  for (std::multimap<timestamp, sessions::session*>::const_iterator
+         it(idle.begin()), end(idle.end());
+       _max_sessions && (_sessions.size() > max) && (it != end);
+       ++it) {
+    log_info(logging::medium) << "session limit reached, closing "
+      "least recently used session "
+      << it->second->get_credentials().get_user() << "@"
+      << it->second->get_credentials().get_host() << ":"
+      << it->second->get_credentials().get_port();
+    _delete_session(it->second);
+  }
+  if (_max_sessions && (_sessions.size() > max))
+    log_debug(logging::medium) << "worker " << this << " has "
+      << _sessions.size() << " sessions but cannot close busy ones";
+  return ;
+}
+
+/**
+ *  Schedule next reaping of idle sessions and start of queued
+ *  sessions if needed.
+ *
+ *  @param[in] now Reschedule an already scheduled task so that queued
+ *                 sessions get started shortly.
+ */
+void worker::_schedule_reaper(bool now) {
+  bool queued(!_connect_queue.empty() || !_warm_queue.empty());
+  if (_reaper && now && queued) {
+    try {
+      multiplexer::instance().task_manager::remove(_reaper);
+    }
+    catch (...) {}
+    _reaper = 0;
+  }
+  if (!_reaper
+      && (((_idle_timeout || _max_sessions) && !_sessions.empty())
+          || queued)) {
+    // Queued sessions are started as tokens become available.
+    timestamp when(timestamp::now());
+    if (!queued)
+      when.add_seconds(1);
+    else
+      when.add_mseconds(100);
+    _reaper = multiplexer::instance().task_manager::add(
+                this,
+                when,
+                false,
+                false);
+  }
+  return ;
+}
+
+/**
+ *  Start queued sessions within the connection rate and the number of
+ *  simultaneous handshakes.
+ */
+void worker::_start_sessions() {
+  // Forget sessions whose handshake is over.
+  for (std::set<sessions::session*>::iterator it(_connecting.begin());
+       it != _connecting.end();)
+    if (!(*it)->is_connecting())
+      _connecting.erase(it++);
+    else
+      ++it;
+
+  // Refill token bucket, it holds one second of connections.
+  if (_connect_rate) {
+    timestamp now(timestamp::now());
+    _tokens += (now.to_useconds() - _tokens_time.to_useconds())
+               * _connect_rate / 1000000.0;
+    if (_tokens > _connect_rate)
+      _tokens = _connect_rate;
+    _tokens_time = now;
+  }
+
+  // Sessions wait for their bastion to start its handshake, once.
+  std::set<sessions::session*> deferred;
+  while (!_connect_queue.empty()
+         && (!_max_handshakes || (_connecting.size() < _max_handshakes))
+         && (!_connect_rate || (_tokens >= 1.0))) {
+    sessions::session* sess(_connect_queue.front().sess);
+    bool use_ipv6(_connect_queue.front().use_ipv6);
+    time_t deadline(_connect_queue.front().deadline);
+    _connect_queue.pop_front();
+    try {
+      sessions::session* bastion(_bastion_of(
+                                   sess->get_credentials(),
+                                   deadline));
+      if (bastion && _is_queued(bastion) && deferred.insert(sess).second) {
+        _queue_session(sess, use_ipv6, deadline);
+        continue ;
+      }
+      if (_connect_rate)
+        _tokens -= 1.0;
+      sess->set_bastion(bastion);
+      sess->connect(use_ipv6);
+      _connecting.insert(sess);
+    }
+    catch (std::exception const& e) {
+      // Checks fail on close, the last of them deletes the session.
+      log_error(logging::low) << "could not connect session "
+        << sess->get_credentials().get_user() << "@"
+        << sess->get_credentials().get_host() << ":"
+        << sess->get_credentials().get_port() << ": " << e.what();
+      sess->close();
+    }
+  }
+
+  // Warm start sessions when no check waits for a session.
+  unsigned int max_warm(_max_handshakes
+                        ? _max_handshakes
+                        : warm_start_handshakes);
+  while (_connect_queue.empty()
+         && !_warm_queue.empty()
+         && (_connecting.size() < max_warm)
+         && (!_connect_rate || (_tokens >= 1.0))) {
+    sessions::session* sess(_warm_queue.front());
+    _warm_queue.pop_front();
+    try {
+      // Bastions of warm started sessions come after checks.
+      sessions::session* bastion(_bastion_of(
+                                   sess->get_credentials(),
+                                   std::numeric_limits<time_t>::max()));
+      if (bastion && _is_queued(bastion)) {
+        _warm_queue.push_front(sess);
+        break ;
+      }
+      if (_connect_rate)
+        _tokens -= 1.0;
+      log_info(logging::medium) << "warm start of session "
+        << sess->get_credentials().get_user() << "@"
+        << sess->get_credentials().get_host() << ":"
+        << sess->get_credentials().get_port();
+      sess->set_bastion(bastion);
+      sess->connect();
+      _connecting.insert(sess);
+    }
+    catch (std::exception const& e) {
+      // No check uses the session.
+      log_error(logging::low) << "could not connect session "
+        << sess->get_credentials().get_user() << "@"
+        << sess->get_credentials().get_host() << ":"
+        << sess->get_credentials().get_port() << ": " << e.what();
+      _delete_session(sess);
+    }
+  }
+
+  if (!_connect_queue.empty())
+    log_debug(logging::medium) << "worker " << this << " has "
+      << _connect_queue.size() << " sessions waiting to connect ("
+      << _connecting.size() << " handshakes in progress)";
+  return ;
+}
@@ -0,0 +1,122 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <ctime>
+#include <list>
+#include <map>
+#include "com/centreon/connector/ssh/checks/coalescer.hh"
+
+using namespace com::centreon::connector::ssh;
+
+/**
+ *  Build a check key.
+ *
+ *  @param[in] host Target host.
+ *  @param[in] cmd  Command.
+ *
+ *  @return Check key.
+ */
+static checks::coalescer::key make_key(
+                                char const* host,
+                                char const* cmd) {
+  checks::coalescer::key k;
+  k.cmds.push_back(cmd);
+  k.creds.set_host(host);
+  k.creds.set_port(22);
+  k.creds.set_user("centreon");
+  k.skip_stderr = -1;
+  k.skip_stdout = -1;
+  k.use_ipv6 = false;
+  return (k);
+}
+
+/**
+ *  Check that checks only attach to identical checks that time out no
+ *  later than themselves, and run again if those were not executed.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  // Return value.
+  int retval(0);
+
+  // Object.
+  checks::coalescer c;
+
+  // First check is executed.
+  retval |= c.attach(1, make_key("host1", "uptime"), 100);
+
+  // Identical check with a later deadline attaches.
+  retval |= !c.attach(2, make_key("host1", "uptime"), 150);
+
+  // Identical check with the same deadline attaches.
+  retval |= !c.attach(3, make_key("host1", "uptime"), 100);
+
+  // Identical check with an earlier deadline is executed.
+  retval |= c.attach(4, make_key("host1", "uptime"), 50);
+
+  // Other command or other host is executed.
+  retval |= c.attach(5, make_key("host1", "df"), 150);
+  retval |= c.attach(6, make_key("host2", "uptime"), 150);
+
+  // Followers get the result of the first check, by deadline.
+  checks::coalescer::key k;
+  std::list<unsigned long long> copies;
+  std::multimap<time_t, unsigned long long> retries;
+  retval |= !c.detach(1, true, 120, k, copies, retries);
+  retval |= (copies.size() != 2);
+  retval |= (copies.empty() || (copies.front() != 3));
+  retval |= (copies.empty() || (copies.back() != 2));
+  retval |= !retries.empty();
+  retval |= (k.creds.get_host() != "host1");
+
+  // Check that was not attached has no follower.
+  copies.clear();
+  retval |= c.detach(4, true, 120, k, copies, retries);
+  retval |= !copies.empty();
+
+  // Once completed, the next identical check is executed.
+  retval |= c.attach(7, make_key("host1", "uptime"), 200);
+
+  // Leader timed out, followers with time left are executed again and
+  // the others get the failure.
+  retval |= !c.attach(8, make_key("host1", "uptime"), 200);
+  retval |= !c.attach(9, make_key("host1", "uptime"), 300);
+  retval |= !c.attach(10, make_key("host1", "uptime"), 250);
+  copies.clear();
+  retval |= !c.detach(7, false, 200, k, copies, retries);
+  retval |= (copies.size() != 1);
+  retval |= (copies.empty() || (copies.front() != 8));
+  retval |= (retries.size() != 2);
+  retval |= (retries.empty() || (retries.begin()->first != 250));
+  retval |= (retries.empty() || (retries.begin()->second != 10));
+  retval |= (k.cmds.empty() || (k.cmds.front() != "uptime"));
+
+  // Earliest retry leads, the later one attaches to it.
+  retval |= c.attach(10, k, 250);
+  retval |= !c.attach(9, k, 300);
+  copies.clear();
+  retries.clear();
+  retval |= !c.detach(10, true, 260, k, copies, retries);
+  retval |= (copies.size() != 1);
+  retval |= (copies.empty() || (copies.front() != 9));
+  retval |= !retries.empty();
+
+  // Return check result.
+  return (static_cast<bool>(retval));
+}
@@ -0,0 +1,127 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "com/centreon/clib.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/process.hh"
+#include "test/connector/binary.hh"
+
+using namespace com::centreon;
+
+#define CMD_HEADER "2\0" \
+                   "4242\0" \
+                   "30\0" \
+                   "123456789\0"
+#define CMD_FOOTER "\0\0\0\0"
+#define RESULT "3\0" \
+               "4242\0"
+
+/**
+ *  Replace null char by string "\0".
+ *
+ *  @param[in, out] str  The string to replace.
+ *
+ *  @return The replace string.
+ */
+std::string& replace_null(std::string& str) {
+  size_t pos(0);
+  while ((pos = str.find('\0', pos)) != std::string::npos)
+    str.replace(pos++, 1, "\\0");
+  return (str);
+}
+
+/**
+ *  Check that a session tunneled through a bastion is closed when its
+ *  peer stops answering keepalives, long before the check timeout.
+ *  The remote command stops the SSH server process serving it, which
+ *  is resumed later so that it does not linger.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  clib::load();
+  // Process.
+  process p;
+  p.enable_stream(process::in, true);
+  p.enable_stream(process::out, true);
+  p.exec(CONNECTOR_SSH_BINARY " --keepalive 1 --keepalive-count 2");
+
+  // Write command.
+  time_t start(time(NULL));
+  std::ostringstream oss;
+  oss.write(CMD_HEADER, sizeof(CMD_HEADER) - 1);
+  oss << "check_by_ssh -H localhost -o ProxyJump=localhost"
+      << " -C '(sleep 25; kill -CONT $PPID) >/dev/null 2>&1 &"
+      << " kill -STOP $PPID; sleep 30'";
+  oss.write(CMD_FOOTER, sizeof(CMD_FOOTER) - 1);
+  std::string cmd(oss.str());
+  char const* ptr(cmd.c_str());
+  unsigned int size(cmd.size());
+  while (size > 0) {
+    unsigned int rb(p.write(ptr, size));
+    size -= rb;
+    ptr += rb;
+  }
+  p.enable_stream(process::in, false);
+
+  // Read reply.
+  std::string output;
+  while (true) {
+    std::string buffer;
+    p.read(buffer);
+    if (buffer.empty())
+      break;
+    output.append(buffer);
+  }
+  time_t elapsed(time(NULL) - start);
+
+  // Wait for process termination.
+  int retval(1);
+  if (!p.wait(5000)) {
+    p.terminate();
+    p.wait();
+  }
+  else
+    retval = (p.exit_code() != 0);
+
+  clib::unload();
+
+  try {
+    if (retval)
+      throw (basic_error() << "invalid return code: " << retval);
+    if (output.size() < (sizeof(RESULT) - 1)
+        || memcmp(output.c_str(), RESULT, sizeof(RESULT) - 1))
+      throw (basic_error()
+             << "invalid output: size=" << output.size()
+             << ", output=" << replace_null(output));
+    if (elapsed > 15)
+      throw (basic_error() << "dead tunneled session was detected after "
+             << elapsed << " seconds");
+  }
+  catch (std::exception const& e) {
+    retval = 1;
+    std::cerr << "error: " << e.what() << std::endl;
+  }
+
+  return (retval);
+}
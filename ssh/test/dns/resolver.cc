@@ -0,0 +1,101 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include "com/centreon/connector/ssh/dns/listener.hh"
+#include "com/centreon/connector/ssh/dns/resolver.hh"
+#include "com/centreon/connector/ssh/multiplexer.hh"
+#include "com/centreon/logging/engine.hh"
+
+using namespace com::centreon::connector::ssh;
+
+/**
+ *  Record lookup result.
+ */
+class         fake_listener : public dns::listener {
+public:
+              fake_listener() : errors(0), resolved(0) {}
+  void        on_resolve_error(std::string const& msg) {
+    (void)msg;
+    ++errors;
+    return ;
+  }
+  void        on_resolved(sockaddr const* addr, socklen_t addrlen) {
+    (void)addrlen;
+    if (addr->sa_family == AF_INET)
+      ++resolved;
+    return ;
+  }
+
+  unsigned int errors;
+  unsigned int resolved;
+};
+
+/**
+ *  Check that host names are resolved asynchronously and cached.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  // Initialization.
+  com::centreon::logging::engine::load();
+  multiplexer::load();
+  dns::resolver::load(60, 10, 2);
+
+  int retval(0);
+  {
+    // Nothing is cached yet.
+    sockaddr_storage addr;
+    socklen_t addrlen(0);
+    retval |= dns::resolver::instance().find(
+                                          "localhost",
+                                          AF_INET,
+                                          addr,
+                                          addrlen);
+
+    // Resolve asynchronously, result is notified by the multiplexer.
+    fake_listener fl;
+    dns::resolver::instance().resolve("localhost", AF_INET, &fl);
+    for (unsigned int i(0); (i < 100) && !fl.resolved && !fl.errors; ++i)
+      multiplexer::instance().multiplex();
+    retval |= (fl.resolved != 1);
+
+    // Address is now cached.
+    retval |= !dns::resolver::instance().find(
+                                           "localhost",
+                                           AF_INET,
+                                           addr,
+                                           addrlen);
+    retval |= (addrlen != sizeof(sockaddr_in));
+
+    // Cancelled lookups are not notified.
+    fake_listener cancelled;
+    dns::resolver::instance().cancel(
+      dns::resolver::instance().resolve("localhost", AF_INET, &cancelled));
+    retval |= (cancelled.resolved || cancelled.errors);
+  }
+
+  // Unload.
+  dns::resolver::unload();
+  multiplexer::unload();
+  com::centreon::logging::engine::unload();
+
+  return (retval);
+}
@@ -0,0 +1,87 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <iostream>
+#include <string>
+#include "com/centreon/connector/ssh/options.hh"
+
+using namespace com::centreon::connector::ssh;
+
+/**
+ *  Get the number of workers from a command line argument.
+ *
+ *  @param[in]  value  Argument value.
+ *  @param[out] result Number of workers.
+ *
+ *  @return true if the value was accepted.
+ */
+static bool get_workers(char const* value, unsigned int& result) {
+  std::string arg("--workers=");
+  arg.append(value);
+  char* argv[] = {
+    const_cast<char*>("centreon_connector_ssh"),
+    const_cast<char*>(arg.c_str()),
+    NULL
+  };
+  try {
+    options opts;
+    opts.parse(2, argv);
+    result = opts.get_workers();
+  }
+  catch (std::exception const& e) {
+    (void)e;
+    return (false);
+  }
+  return (true);
+}
+
+/**
+ *  Check that unsigned integer arguments reject signs, garbage and
+ *  values that do not fit.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  // Return value.
+  int retval(0);
+
+  // Valid value.
+  unsigned int result(0);
+  retval |= !get_workers("42", result) || (result != 42);
+  retval |= !get_workers("4294967295", result) || (result != 4294967295u);
+
+  // Invalid values.
+  char const* const invalid[] = {
+    "-1",
+    "+1",
+    " 1",
+    "",
+    "4x",
+    "4294967296",
+    "99999999999999999999999"
+  };
+  for (unsigned int i(0); i < sizeof(invalid) / sizeof(*invalid); ++i)
+    if (get_workers(invalid[i], result)) {
+      std::cerr << "value '" << invalid[i] << "' was accepted as "
+                << result << std::endl;
+      retval = 1;
+    }
+
+  // Return check result.
+  return (retval);
+}
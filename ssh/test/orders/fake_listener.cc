@@ -111,6 +111,7 @@ void fake_listener::on_error(
  *  @param[in] skip_stdout Should stdout be skipped.
  *  @param[in] skip_stderr Should stderr be skipped.
  *  @param[in] is_ipv6     Work with IPv6.
+ *  @param[in] ssh_options SSH options.
  */
 void fake_listener::on_execute(
                       unsigned long long cmd_id,
@@ -123,7 +124,8 @@ void fake_listener::on_execute(
                       std::list<std::string> const& cmds,
                       int skip_stdout,
                       int skip_stderr,
-                      bool is_ipv6) {
+                      bool is_ipv6,
+                      std::map<std::string, std::string> const& ssh_options) {
   callback_info ci;
   ci.callback = cb_execute;
   ci.cmd_id = cmd_id;
@@ -137,6 +139,7 @@ void fake_listener::on_execute(
   ci.skip_stdout = skip_stdout;
   ci.skip_stderr = skip_stderr;
   ci.is_ipv6 = is_ipv6;
+  ci.ssh_options = ssh_options;
   _callbacks.push_back(ci);
   return ;
 }
@@ -216,6 +219,7 @@ bool operator==(
                   || (it1->skip_stdout != it2->skip_stdout)
                   || (it1->skip_stderr != it2->skip_stderr)
                   || (it1->is_ipv6 != it2->is_ipv6)
+                  || (it1->ssh_options != it2->ssh_options)
                   || (it1->cmds != it2->cmds))))
         retval = false;
   }
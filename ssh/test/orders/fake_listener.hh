@@ -20,6 +20,7 @@
 #  define TEST_ORDERS_FAKE_LISTENER_HH
 
 #  include <list>
+#  include <map>
 #  include "com/centreon/connector/ssh/orders/listener.hh"
 
 /**
@@ -53,6 +54,8 @@ public:
     int            skip_stderr;
     int            skip_stdout;
     bool           is_ipv6;
+    std::map<std::string, std::string>
+                   ssh_options;
   };
 
                    fake_listener();
@@ -76,7 +79,8 @@ public:
                      std::list<std::string> const& cmds,
                      int skip_stdout,
                      int skip_stderr,
-                     bool is_ipv6);
+                     bool is_ipv6,
+                     std::map<std::string, std::string> const& ssh_options);
   void             on_quit();
   void             on_version();
 
@@ -0,0 +1,116 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstring>
+#include <map>
+#include <string>
+#include "com/centreon/connector/ssh/orders/parser.hh"
+#include "com/centreon/logging/engine.hh"
+#include "test/orders/buffer_handle.hh"
+#include "test/orders/fake_listener.hh"
+
+using namespace com::centreon::connector::ssh::orders;
+
+/**
+ *  Write an execution order.
+ *
+ *  @param[out] bh      Buffer.
+ *  @param[in]  cmdline Check command line.
+ */
+static void write_order(buffer_handle& bh, char const* cmdline) {
+  char const* str;
+  str = "2"; // Order ID.
+  bh.write(str, strlen(str) + 1);
+  str = "42"; // Command ID.
+  bh.write(str, strlen(str) + 1);
+  str = "10"; // Timeout.
+  bh.write(str, strlen(str) + 1);
+  str = "4241"; // Start time.
+  bh.write(str, strlen(str) + 1);
+  bh.write(cmdline, strlen(cmdline));
+  bh.write("\0\0\0\0", 4);
+  return ;
+}
+
+/**
+ *  Check that SSH options of execution orders are properly parsed.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  // Initialization.
+  com::centreon::logging::engine::load();
+
+  // Create execution order packets.
+  buffer_handle bh;
+  write_order(
+    bh,
+    "check_by_ssh -H localhost -l root -o Ciphers=aes128-ctr "
+    "-o \"kexalgorithms diffie-hellman-group14-sha1\" "
+    "-o Compression=Yes -o ProxyJump=admin@bastion:2222 -C ls");
+  write_order(
+    bh,
+    "check_by_ssh -H localhost -l root -o ForwardAgent=yes -C ls");
+  write_order(
+    bh,
+    "check_by_ssh -H localhost -l root -o Compression=maybe -C ls");
+
+  // Listener.
+  fake_listener listnr;
+
+  // Parser.
+  parser p;
+  p.listen(&listnr);
+  while (!bh.empty())
+    p.read(bh);
+  p.read(bh);
+
+  // Checks.
+  int retval(0);
+
+  // Listener must have received execute, two errors and eof.
+  std::list<fake_listener::callback_info> const&
+    cbs(listnr.get_callbacks());
+  if (cbs.size() != 4)
+    retval = 1;
+  else {
+    std::list<fake_listener::callback_info>::const_iterator
+      it(cbs.begin());
+    std::map<std::string, std::string> expected;
+    expected["Ciphers"] = "aes128-ctr";
+    expected["Compression"] = "yes";
+    expected["KexAlgorithms"] = "diffie-hellman-group14-sha1";
+    expected["ProxyJump"] = "admin@bastion:2222";
+    retval |= ((it->callback != fake_listener::cb_execute)
+               || (it->ssh_options != expected));
+    ++it;
+    retval |= (it->callback != fake_listener::cb_error);
+    ++it;
+    retval |= (it->callback != fake_listener::cb_error);
+    ++it;
+    retval |= (it->callback != fake_listener::cb_eof);
+  }
+
+  // Parser must be empty.
+  retval |= !p.get_buffer().empty();
+
+  // Unload.
+  com::centreon::logging::engine::unload();
+
+  return (retval);
+}
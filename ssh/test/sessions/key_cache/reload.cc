@@ -0,0 +1,99 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/time.h>
+#include <unistd.h>
+#include "com/centreon/connector/ssh/sessions/key_cache.hh"
+#include "com/centreon/exceptions/basic.hh"
+#include "com/centreon/logging/engine.hh"
+
+using namespace com::centreon::connector::ssh;
+
+/**
+ *  Write a file with a given modification time.
+ *
+ *  @param[in] path    File path.
+ *  @param[in] content File content.
+ *  @param[in] mtime   Modification time.
+ */
+static void write_file(
+              std::string const& path,
+              std::string const& content,
+              time_t mtime) {
+  {
+    std::ofstream ofs(path.c_str());
+    ofs << content;
+  }
+  timeval times[2];
+  times[0].tv_sec = mtime;
+  times[0].tv_usec = 0;
+  times[1] = times[0];
+  utimes(path.c_str(), times);
+  return ;
+}
+
+/**
+ *  Check that key files are cached and reloaded when modified.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  // Initialization.
+  com::centreon::logging::engine::load();
+  sessions::key_cache::load();
+
+  int retval(0);
+  char path[] = "/tmp/key_cache.XXXXXX";
+  int fd(mkstemp(path));
+  if (fd < 0)
+    retval = 1;
+  else {
+    close(fd);
+
+    // First read.
+    std::string data;
+    write_file(path, "first key", 1000);
+    sessions::key_cache::instance().get(path, data);
+    retval |= (data != "first key");
+
+    // Modification time changed, file is read again.
+    write_file(path, "second key", 2000);
+    sessions::key_cache::instance().get(path, data);
+    retval |= (data != "second key");
+
+    // Removed file.
+    remove(path);
+    try {
+      sessions::key_cache::instance().get(path, data);
+      retval |= 1;
+    }
+    catch (com::centreon::exceptions::basic const& e) {
+      (void)e;
+    }
+  }
+
+  // Unload.
+  sessions::key_cache::unload();
+  com::centreon::logging::engine::unload();
+
+  return (retval);
+}
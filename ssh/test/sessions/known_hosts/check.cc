@@ -0,0 +1,107 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <libssh2.h>
+#include <string>
+#include <sys/time.h>
+#include <unistd.h>
+#include "com/centreon/connector/ssh/sessions/known_hosts.hh"
+#include "com/centreon/logging/engine.hh"
+
+using namespace com::centreon::connector::ssh;
+
+/**
+ *  Write a known_hosts file with a given modification time.
+ *
+ *  @param[in] path    File path.
+ *  @param[in] content File content.
+ *  @param[in] mtime   Modification time.
+ */
+static void write_file(
+              std::string const& path,
+              std::string const& content,
+              time_t mtime) {
+  {
+    std::ofstream ofs(path.c_str());
+    ofs << content;
+  }
+  timeval times[2];
+  times[0].tv_sec = mtime;
+  times[0].tv_usec = 0;
+  times[1] = times[0];
+  utimes(path.c_str(), times);
+  return ;
+}
+
+/**
+ *  Check that host keys are checked against a shared known_hosts
+ *  list which is reloaded when the file changes.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  // Initialization.
+  com::centreon::logging::engine::load();
+  libssh2_init(0);
+  sessions::known_hosts::load();
+
+  int retval(0);
+  char path[] = "/tmp/known_hosts.XXXXXX";
+  int fd(mkstemp(path));
+  if (fd < 0)
+    retval = 1;
+  else {
+    close(fd);
+    std::string key("0123456789abcdef");
+    std::string other("fedcba9876543210");
+
+    // Base64 of key.
+    write_file(
+      path,
+      "myhost ssh-rsa MDEyMzQ1Njc4OWFiY2RlZg==\n",
+      1000);
+    sessions::known_hosts& kh(sessions::known_hosts::instance());
+    retval |= (kh.check(path, "myhost", key.data(), key.size())
+               != LIBSSH2_KNOWNHOST_CHECK_MATCH);
+    retval |= (kh.check(path, "myhost", other.data(), other.size())
+               != LIBSSH2_KNOWNHOST_CHECK_MISMATCH);
+    retval |= (kh.check(path, "otherhost", key.data(), key.size())
+               != LIBSSH2_KNOWNHOST_CHECK_NOTFOUND);
+
+    // File changed, results must follow.
+    write_file(
+      path,
+      "otherhost ssh-rsa MDEyMzQ1Njc4OWFiY2RlZg==\n",
+      2000);
+    retval |= (kh.check(path, "myhost", key.data(), key.size())
+               != LIBSSH2_KNOWNHOST_CHECK_NOTFOUND);
+    retval |= (kh.check(path, "otherhost", key.data(), key.size())
+               != LIBSSH2_KNOWNHOST_CHECK_MATCH);
+    remove(path);
+  }
+
+  // Unload.
+  sessions::known_hosts::unload();
+  libssh2_exit();
+  com::centreon::logging::engine::unload();
+
+  return (retval);
+}
@@ -0,0 +1,215 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <poll.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "com/centreon/connector/ssh/sessions/shell.hh"
+
+using namespace com::centreon::connector::ssh::sessions;
+
+#define TOKEN "CCCS_test_1"
+
+/**
+ *  Local shell that plays the role of the remote one.
+ */
+struct        local_shell {
+  int         err;
+  int         in;
+  int         out;
+  pid_t       pid;
+};
+
+/**
+ *  Start /bin/sh with its standard streams redirected to pipes.
+ *
+ *  @param[out] sh Shell.
+ *
+ *  @return true on success.
+ */
+static bool start_shell(local_shell& sh) {
+  int in[2];
+  int out[2];
+  int err[2];
+  if (pipe(in) || pipe(out) || pipe(err))
+    return (false);
+  sh.pid = fork();
+  if (sh.pid < 0)
+    return (false);
+  if (!sh.pid) {
+    dup2(in[0], STDIN_FILENO);
+    dup2(out[1], STDOUT_FILENO);
+    dup2(err[1], STDERR_FILENO);
+    close(in[0]);
+    close(in[1]);
+    close(out[0]);
+    close(out[1]);
+    close(err[0]);
+    close(err[1]);
+    execl("/bin/sh", "sh", (char*)NULL);
+    _exit(127);
+  }
+  close(in[0]);
+  close(out[1]);
+  close(err[1]);
+  sh.in = in[1];
+  sh.out = out[0];
+  sh.err = err[0];
+  return (true);
+}
+
+/**
+ *  Run a wrapped command in the local shell and parse its result.
+ *
+ *  @param[in]  sh        Shell.
+ *  @param[in]  cmd       Command.
+ *  @param[out] out       Command output.
+ *  @param[out] err       Command error output.
+ *  @param[out] exit_code Command exit code.
+ *
+ *  @return true if the command result could be parsed.
+ */
+static bool run(
+              local_shell& sh,
+              std::string const& cmd,
+              std::string& out,
+              std::string& err,
+              int& exit_code) {
+  std::string input(shell::wrap(cmd, TOKEN));
+  if (write(sh.in, input.data(), input.size())
+      != static_cast<ssize_t>(input.size()))
+    return (false);
+  std::string out_buffer;
+  std::string err_buffer;
+  while (!shell::parse(
+            TOKEN,
+            out_buffer,
+            err_buffer,
+            out,
+            err,
+            exit_code)) {
+    pollfd fds[2];
+    fds[0].fd = sh.out;
+    fds[0].events = POLLIN;
+    fds[1].fd = sh.err;
+    fds[1].events = POLLIN;
+    if (poll(fds, 2, 5000) <= 0)
+      return (false);
+    for (int i(0); i < 2; ++i)
+      if (fds[i].revents) {
+        char buffer[1024];
+        ssize_t rb(read(fds[i].fd, buffer, sizeof(buffer)));
+        if (rb <= 0)
+          return (false);
+        (i ? err_buffer : out_buffer).append(buffer, rb);
+      }
+  }
+  return (out_buffer.empty() && err_buffer.empty());
+}
+
+/**
+ *  Check a command result.
+ *
+ *  @param[in] sh        Shell.
+ *  @param[in] cmd       Command.
+ *  @param[in] out       Expected output.
+ *  @param[in] err       Expected error output.
+ *  @param[in] exit_code Expected exit code.
+ *
+ *  @return 0 if the command returned the expected result.
+ */
+static int check(
+             local_shell& sh,
+             std::string const& cmd,
+             std::string const& out,
+             std::string const& err,
+             int exit_code) {
+  std::string real_out;
+  std::string real_err;
+  int real_exit_code(-1);
+  if (!run(sh, cmd, real_out, real_err, real_exit_code)
+      || (real_out != out)
+      || (real_err != err)
+      || (real_exit_code != exit_code)) {
+    std::cerr << "command '" << cmd << "' returned exit code "
+              << real_exit_code << ", output '" << real_out
+              << "' and error '" << real_err << "'" << std::endl;
+    return (1);
+  }
+  return (0);
+}
+
+/**
+ *  Check that commands run in a persistent shell are delimited
+ *  properly.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  int retval(0);
+
+  // Incomplete results are not parsed.
+  {
+    std::string out_buffer("output\n" TOKEN " 0\n");
+    std::string err_buffer("error");
+    std::string out;
+    std::string err;
+    int exit_code;
+    if (shell::parse(
+          TOKEN,
+          out_buffer,
+          err_buffer,
+          out,
+          err,
+          exit_code)) {
+      std::cerr << "incomplete result was parsed" << std::endl;
+      retval = 1;
+    }
+  }
+
+  // Commands run one after another in the same shell.
+  local_shell sh;
+  if (!start_shell(sh)) {
+    std::cerr << "could not start shell" << std::endl;
+    return (1);
+  }
+  retval |= check(sh, "echo output", "output\n", "", 0);
+  retval |= check(sh, "exit 3", "", "", 3);
+  retval |= check(sh, "false", "", "", 1);
+  retval |= check(sh, "echo error >&2; exit 2", "", "error\n", 2);
+  retval |= check(sh, "printf output", "output", "", 0);
+  retval |= check(
+              sh,
+              "printf output; printf error >&2",
+              "output",
+              "error",
+              0);
+  retval |= check(sh, "printf '\\n\\n'", "\n\n", "", 0);
+
+  // Terminate shell.
+  close(sh.in);
+  close(sh.out);
+  close(sh.err);
+  waitpid(sh.pid, NULL, 0);
+
+  return (retval);
+}
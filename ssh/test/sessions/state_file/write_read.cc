@@ -0,0 +1,100 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <string>
+#include <unistd.h>
+#include "com/centreon/connector/ssh/sessions/state_file.hh"
+#include "com/centreon/logging/engine.hh"
+
+using namespace com::centreon::connector::ssh;
+
+/**
+ *  Check that sessions are written to and read from a state file.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  // Initialization.
+  com::centreon::logging::engine::load();
+
+  int retval(0);
+  char path[] = "/tmp/state_file.XXXXXX";
+  int fd(mkstemp(path));
+  if (fd < 0)
+    retval = 1;
+  else {
+    close(fd);
+
+    // Save sessions, the one using a password is ignored.
+    {
+      sessions::state_file sf(path);
+      sessions::credentials with_key(
+                              "localhost",
+                              "centreon",
+                              "",
+                              "/home/centreon/.ssh/id_rsa",
+                              2222);
+      std::map<std::string, std::string> opts;
+      opts["Ciphers"] = "aes128-ctr,aes256-ctr";
+      opts["Compression"] = "yes";
+      with_key.set_ssh_options(opts);
+      sessions::credentials with_password(
+                              "remote",
+                              "root",
+                              "secret",
+                              "",
+                              22);
+      sf.add(with_key);
+      sf.add(with_password);
+      sf.write();
+    }
+
+    // Read them back.
+    std::list<sessions::credentials> creds;
+    sessions::state_file(path).read(creds);
+    retval |= (creds.size() != 1);
+    if (!creds.empty()) {
+      sessions::credentials const& c(creds.front());
+      retval |= ((c.get_host() != "localhost")
+                 || (c.get_user() != "centreon")
+                 || !c.get_password().empty()
+                 || (c.get_key() != "/home/centreon/.ssh/id_rsa")
+                 || (c.get_port() != 2222)
+                 || (c.get_ssh_options().size() != 2));
+      std::map<std::string, std::string>::const_iterator
+        it(c.get_ssh_options().find("Ciphers"));
+      retval |= ((it == c.get_ssh_options().end())
+                 || (it->second != "aes128-ctr,aes256-ctr"));
+    }
+    remove(path);
+
+    // Missing file.
+    creds.clear();
+    sessions::state_file(path).read(creds);
+    retval |= !creds.empty();
+  }
+
+  // Unload.
+  com::centreon::logging::engine::unload();
+
+  return (retval);
+}
@@ -0,0 +1,50 @@
+/*
+** Copyright 2019 Centreon
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+**
+** For more information : contact@centreon.com
+*/
+
+#include "com/centreon/connector/ssh/wakeup.hh"
+
+using namespace com::centreon::connector::ssh;
+
+/**
+ *  Check that wakeup notifications can be read back and drained.
+ *
+ *  @return 0 on success.
+ */
+int main() {
+  // Return value.
+  int retval(0);
+
+  // Object.
+  wakeup w;
+
+  // Nothing to read before notification.
+  char buffer[16];
+  retval |= (w.read(buffer, sizeof(buffer)) != 0);
+
+  // Notify twice.
+  w.wake();
+  w.wake();
+  retval |= (w.read(buffer, sizeof(buffer)) != 2);
+
+  // Drain.
+  w.wake();
+  w.read(static_cast<com::centreon::handle&>(w));
+  retval |= (w.read(buffer, sizeof(buffer)) != 0);
+
+  return (retval);
+}